@@ -0,0 +1,42 @@
+#include "AllocationCounter.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+void AllocationCounter::newEvent() {
+  long now = allocations();
+  if(now < 0) return;
+  if(events > 0) {
+    totalAllocations += now - allocationsAtStart;
+    maxAllocations = std::max(maxAllocations, now - allocationsAtStart);
+  }
+  allocationsAtStart = now;
+  events++;
+}
+
+void AllocationCounter::print() const {
+  if(allocations() < 0 || events < 2) return;
+  std::cout << "Allocations per event: " << static_cast<double>(totalAllocations)/(events - 1)
+            << " on average, " << maxAllocations << " at most" << std::endl;
+}
+
+#ifdef PROFILE_ALLOCS
+#include <atomic>
+
+static std::atomic<long> allocationCount(0);
+
+void* operator new(size_t size) {
+  allocationCount++;
+  void* memory = malloc(size ? size : 1);
+  if(memory == nullptr) throw std::bad_alloc();
+  return memory;
+}
+
+void operator delete(void* memory) noexcept {free(memory);}
+void operator delete(void* memory, size_t) noexcept {free(memory);}
+
+long AllocationCounter::allocations() {return allocationCount;}
+#else
+long AllocationCounter::allocations() {return -1;}
+#endif
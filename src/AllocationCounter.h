@@ -0,0 +1,28 @@
+#ifndef AllocationCounter_h
+#define AllocationCounter_h
+
+/*
+AllocationCounter: heap allocations per event.
+
+Built with PROFILE_ALLOCS (make PROFILE_ALLOCS=1) every operator new of the program is
+counted, newEvent() (Analyzer::clear_values) closes the count of the previous event and
+print() shows the mean and largest number per event.  Without PROFILE_ALLOCS nothing is
+counted and print() is silent.
+
+The count is global: with several configurations (-C cfgA,cfgB) one event includes the
+allocations of all of them, so only the analyzer owning the input keeps and prints it.
+There is no per-event arena, the event path reuses the capacity of its member containers.
+*/
+class AllocationCounter {
+public:
+  void newEvent();
+  void print() const;
+
+  ////operator new calls of the program, -1 if not built with PROFILE_ALLOCS
+  static long allocations();
+
+private:
+  long events = 0, allocationsAtStart = 0, maxAllocations = 0, totalAllocations = 0;
+};
+
+#endif
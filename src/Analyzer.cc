@@ -14,7 +14,7 @@
 ///// if tests show no loss in speed
 #define histAddVal2(val1, val2, name) ihisto.addVal(val1, val2, group, max, name, wgt)
 #define histAddVal(val, name) ihisto.addVal(val, group, max, name, wgt)
-#define SetBranch(name, variable) BOOM->SetBranchStatus(name, 1);  BOOM->SetBranchAddress(name, &variable);
+#define SetBranch(name, variable) BranchRegistry::get(BOOM).bind(name, variable);
 
 typedef std::vector<int>::iterator vec_iter;
 
@@ -45,6 +45,12 @@ const std::vector<CUTS> Analyzer::nonParticleCuts = {
   CUTS::eRVertex,CUTS::eRTrig1, CUTS::eRTrig2,
 };
 
+const std::vector<std::pair<std::string, CUTS> > Analyzer::overlapNames = {
+  {"RemoveOverlapWithMuon1s", CUTS::eRMuon1}, {"RemoveOverlapWithMuon2s", CUTS::eRMuon2},
+  {"RemoveOverlapWithElectron1s", CUTS::eRElec1}, {"RemoveOverlapWithElectron2s", CUTS::eRElec2},
+  {"RemoveOverlapWithTau1s", CUTS::eRTau1}, {"RemoveOverlapWithTau2s", CUTS::eRTau2}
+};
+
 const std::unordered_map<std::string, CUTS> Analyzer::cut_num = {
   {"NGenTau", CUTS::eGTau},                             {"NGenTop", CUTS::eGTop},
   {"NGenElectron", CUTS::eGElec},                       {"NGenMuon", CUTS::eGMuon},
@@ -78,27 +84,29 @@ const std::unordered_map<std::string, CUTS> Analyzer::cut_num = {
 //////////////////////////////////////////////////////
 
 ///Constructor
-Analyzer::Analyzer(std::vector<std::string> infiles, std::string outfile, bool setCR, std::string configFolder) : goodParts(getArray()), genName_regex(".*([A-Z][^[:space:]]+)"){
+Analyzer::Analyzer(std::vector<std::string> infiles, std::string outfile, bool setCR, std::string configFolder, Analyzer* sharedInput, bool cutScan) : goodParts(getArray()), genName_regex(".*([A-Z][^[:space:]]+)"){
   std::cout << "setup start" << std::endl;
 
-  BOOM= new TChain("TNT/BOOM");
-  infoFile=0;
+  if(sharedInput != nullptr) {
+    ////read once, the branches we need are added to the ones of the first configuration
+    BOOM = sharedInput->BOOM;
+    ownsInput = false;
+    nentries = sharedInput->nentries;
+  } else {
+    BOOM= new TChain("TNT/BOOM");
 
-  for( std::string infile: infiles){
-    BOOM->AddFile(infile.c_str());
-  }
+    for( std::string infile: infiles){
+      BOOM->AddFile(infile.c_str());
+    }
 
 
-  nentries = (int) BOOM->GetEntries();
-  BOOM->SetBranchStatus("*", 0);
+    nentries = (int) BOOM->GetEntries();
+    BOOM->SetBranchStatus("*", 0);
+  }
   std::cout << "TOTAL EVENTS: " << nentries << std::endl;
 
-  srand(0);
-
   for(int i=0; i < nTrigReq; i++) {
-    std::vector<int>* tmpi = new std::vector<int>();
     std::vector<std::string>* tmps = new std::vector<std::string>();
-    trigPlace[i] = tmpi;
     trigName[i] = tmps;
   }
 
@@ -106,6 +114,17 @@ Analyzer::Analyzer(std::vector<std::string> infiles, std::string outfile, bool s
   filespace+="/";
 
   setupGeneral();
+  cutScanOnly = cutScan;
+  if(cutScanOnly) {
+    ////the scan copy only needs the nominal selection
+    distats["Systematics"].bset.clear();
+    distats["Run"].dmap.erase("BootstrapReplicas");
+    distats["Run"].smap.erase("PdfWeightBranch");
+    for(std::string option: {"FillNMinusOne", "WriteCutMask", "MonitorWeights"}) {
+      auto found = std::find(distats["Run"].bset.begin(), distats["Run"].bset.end(), option);
+      if(found != distats["Run"].bset.end()) distats["Run"].bset.erase(found);
+    }
+  }
 
   reader.load(calib, BTagEntry::FLAV_B, "comb");
 
@@ -113,32 +132,66 @@ Analyzer::Analyzer(std::vector<std::string> infiles, std::string outfile, bool s
 
   CalculatePUSystematics = distats["Run"].bfind("CalculatePUSystematics");
   initializePileupInfo(distats["Run"].smap.at("MCHistos"), distats["Run"].smap.at("DataHistos"),distats["Run"].smap.at("DataPUHistName"),distats["Run"].smap.at("MCPUHistName"));
-  syst_names.push_back("orig");
+  systs.add("orig");
   std::unordered_map<CUTS, std::vector<int>*, EnumHash> tmp;
   syst_parts.push_back(tmp);
   if(!isData && distats["Systematics"].bfind("useSystematics")) {
+    std::vector<std::pair<std::string, int> > requested;
     for(auto systname : distats["Systematics"].bset) {
       if( systname == "useSystematics")
         doSystematics= true;
-      else {
-        syst_names.push_back(systname);
+      else if(systname == "Jet_Scale_Sources") {
+        ////an up and a down systematic for every JES source
+        std::string sourceFile = "Pileup/Summer16_23Sep2016V4_MC_UncertaintySources_AK4PFchs.txt";
+        if(distats["Jet_systematics"].smap.find("jetScaleSourcesFile") != distats["Jet_systematics"].smap.end()) {
+          sourceFile = distats["Jet_systematics"].smap.at("jetScaleSourcesFile");
+        }
+        jetScaleRes.InitSources(sourceFile, JetScaleResolution::defaultSources);
+        for(size_t source = 0; source < jetScaleRes.GetSourceNames().size(); source++) {
+          requested.push_back(std::make_pair("Jet_Scale_" + jetScaleRes.GetSourceNames()[source] + "_Up", source));
+          requested.push_back(std::make_pair("Jet_Scale_" + jetScaleRes.GetSourceNames()[source] + "_Down", source));
+        }
+      }
+      else requested.push_back(std::make_pair(systname, -1));
+    }
+    for(auto systname : requested) {
+      int isyst = systs.add(systname.first, systname.second);
+      ////weight systematics keep the nominal selection, no particles needed
+      if(systs.at(isyst).isWeight()) {
+        weightSysts.push_back(isyst);
+        syst_parts.push_back(tmp);
+      } else {
         syst_parts.push_back(getArray());
       }
     }
   }else {
     doSystematics=false;
   }
-
-  _Electron = new Electron(BOOM, filespace + "Electron_info.in", syst_names);
-  _Muon     = new Muon(BOOM, filespace + "Muon_info.in", syst_names);
-  _Tau      = new Taus(BOOM, filespace + "Tau_info.in", syst_names);
-  _Jet      = new Jet(BOOM, filespace + "Jet_info.in", syst_names);
-  _FatJet   = new FatJet(BOOM, filespace + "FatJet_info.in", syst_names);
-  _MET      = new Met(BOOM, "Met_type1PF" , syst_names, distats["Run"].dmap.at("MT2Mass"));
+  syst_names = systs.names();
+  nJesSources = jetScaleRes.GetSourceNames().size();
+
+  _Electron = new Electron(BOOM, filespace + "Electron_info.in", systs);
+  _Muon     = new Muon(BOOM, filespace + "Muon_info.in", systs);
+  _Tau      = new Taus(BOOM, filespace + "Tau_info.in", systs);
+  _Jet      = new Jet(BOOM, filespace + "Jet_info.in", systs);
+  _FatJet   = new FatJet(BOOM, filespace + "FatJet_info.in", systs);
+  _MET      = new Met(BOOM, "Met_type1PF" , systs, distats["Run"].dmap.at("MT2Mass"));
+  if(distats["Run"].dmap.find("MT2Precision") != distats["Run"].dmap.end()) _MET->setMT2Precision(distats["Run"].dmap.at("MT2Precision"));
+
+  electronSelections.add(CUTS::eRElec1, _Electron->pstats["Elec1"]);
+  electronSelections.add(CUTS::eRElec2, _Electron->pstats["Elec2"]);
+  muonSelections.add(CUTS::eRMuon1, _Muon->pstats["Muon1"]);
+  muonSelections.add(CUTS::eRMuon2, _Muon->pstats["Muon2"]);
+  tauSelections.add(CUTS::eRTau1, _Tau->pstats["Tau1"]);
+  tauSelections.add(CUTS::eRTau2, _Tau->pstats["Tau2"]);
+  bJetSelections.add(CUTS::eRBJet, _Jet->pstats["BJet"]);
+  jetSelections.add(CUTS::eRJet1, _Jet->pstats["Jet1"]);
+  jetSelections.add(CUTS::eRJet2, _Jet->pstats["Jet2"]);
+  jetSelections.add(CUTS::eRCenJet, _Jet->pstats["CentralJet"]);
 
   if(!isData) {
     std::cout<<"This is MC if not, change the flag!"<<std::endl;
-    _Gen = new Generated(BOOM, filespace + "Gen_info.in", syst_names);
+    _Gen = new Generated(BOOM, filespace + "Gen_info.in", systs);
     allParticles= {_Gen,_Electron,_Muon,_Tau,_Jet,_FatJet};
   } else {
     std::cout<<"This is Data if not, change the flag!"<<std::endl;
@@ -183,11 +236,66 @@ Analyzer::Analyzer(std::vector<std::string> infiles, std::string outfile, bool s
   }
   //we update the root file if it exist so now we have to delete it:
   std::remove(outfile.c_str()); // delete file
-  histo = Histogramer(1, filespace+"Hist_entries.in", filespace+"Cuts.in", outfile, isData, cr_variables);
-  if(doSystematics)
+  ////weight variations stored in the ntuple, filled together with the histograms marked 'weights'
+  int npdf = 1;
+  if(!isData && distats["Run"].smap.find("PdfWeightBranch") != distats["Run"].smap.end()) {
+    if(distats["Run"].dmap.find("NPdfWeights") == distats["Run"].dmap.end()) {
+      std::cout << "ERROR: PdfWeightBranch needs NPdfWeights in Run_info.in" << std::endl;
+      exit(1);
+    }
+    SetBranch(distats["Run"].smap.at("PdfWeightBranch"), pdf_weights);
+    npdf = distats["Run"].dmap.at("NPdfWeights");
+    usePdfWeights = true;
+  }
+  ////Poisson bootstrap replicas, filled like the weight variations above
+  if(distats["Run"].dmap.find("BootstrapReplicas") != distats["Run"].dmap.end() && distats["Run"].dmap.at("BootstrapReplicas") > 0) {
+    if(usePdfWeights) {
+      std::cout << "ERROR: the bootstrap replicas and PdfWeightBranch can't be used at the same time" << std::endl;
+      exit(1);
+    }
+    if(distats["Run"].smap.find("BootstrapEventBranch") != distats["Run"].smap.end()) bootstrapBranch = distats["Run"].smap.at("BootstrapEventBranch");
+    if(BOOM->GetBranch(bootstrapBranch.c_str()) == nullptr) {
+      std::cout << "ERROR: no branch " << bootstrapBranch << " to seed the bootstrap replicas" << std::endl;
+      exit(1);
+    }
+    BOOM->SetBranchStatus(bootstrapBranch.c_str(), 1);
+    npdf = distats["Run"].dmap.at("BootstrapReplicas");
+    useBootstrap = true;
+  }
+  histo = Histogramer(npdf, filespace+"Hist_entries.in", filespace+"Cuts.in", outfile, isData, cr_variables);
+  ////fill each value once into the last folder passed, folders are summed up when writing
+  if(distats["Run"].bfind("FillFoldersOnWrite")) histo.setCumulativeFill();
+  if(usePdfWeights) histo.setMultiWeightsAsTH2(distats["Run"].bfind("PdfWeightsAsTH2"));
+  if(useBootstrap) histo.setMultiWeightsAsTH2(distats["Run"].bfind("BootstrapAsTH2"));
+  if(useBootstrap) {
+    uint64_t seed = (distats["Run"].dmap.find("BootstrapSeed") != distats["Run"].dmap.end()) ? distats["Run"].dmap.at("BootstrapSeed") : 0;
+    bootstrap = new Bootstrap(npdf, histo.get_cutorder()->size(), seed);
+    std::cout << "Using " << npdf << " bootstrap replicas" << std::endl;
+  }
+  if(doSystematics) {
     syst_histo=Histogramer(1, filespace+"Hist_syst_entries.in", filespace+"Cuts.in", outfile, isData, cr_variables,syst_names);
+    syst_histo.setWeightColumns(weightSysts);
+    weightScales.assign(weightSysts.size(), 1.);
+  }
+  if(histo.get_cutorder()->size() > 64) {
+    std::cout << "ERROR: more than 64 cuts in Cuts.in, can't keep the cut mask" << std::endl;
+    exit(1);
+  }
+  if(distats["Run"].bfind("FillNMinusOne") && !setCR) {
+    doNMinusOne = true;
+    nminus1_histo=Histogramer(1, filespace+"Hist_entries.in", filespace+"Cuts.in", outfile, isData, cr_variables, *histo.get_cutorder());
+    nminus1_histo.setNMinusOneFill();
+  }
+  if(distats["Run"].bfind("WriteCutMask") && !setCR) openCutMaskFile(outfile);
+  reuseNominal = doSystematics && distats["Run"].bfind("ReuseNominalSelection");
+  if(distats["Run"].bfind("AdaptiveCutOrder")) {
+    auto warmup = distats["Run"].dmap.find("CutOrderWarmup");
+    cutOrderWarmup = (warmup != distats["Run"].dmap.end()) ? warmup->second : 1000;
+  }
   systematics = Systematics(distats);
-  jetScaleRes = JetScaleResolution("Pileup/Summer16_23Sep2016V4_MC_Uncertainty_AK4PFchs.txt", "",  "Pileup/Spring16_25nsV6_MC_PtResolution_AK4PFchs.txt", "Pileup/Spring16_25nsV6_MC_SF_AK4PFchs.txt");
+  ////not reassigned, it may hold the JES sources already
+  jetScaleRes.InitScale("Pileup/Summer16_23Sep2016V4_MC_Uncertainty_AK4PFchs.txt", "");
+  jetScaleRes.InitResolution("Pileup/Spring16_25nsV6_MC_PtResolution_AK4PFchs.txt", "Pileup/Spring16_25nsV6_MC_SF_AK4PFchs.txt");
 
 
 
@@ -230,16 +338,23 @@ Analyzer::Analyzer(std::vector<std::string> infiles, std::string outfile, bool s
 
     setupCR(maper.first, maper.second);
   }
-  // check if we need to make gen level cuts to cross clean the samples:
-  for(auto iselect : gen_selection){
-    if(iselect.second){
-      std::cout<<"Waning: The selection "<< iselect.first<< " is active!"<<std::endl;
+  if(distats["Run"].bfind("DoCutScan")) {
+    if(setCR) {
+      std::cout << "ERROR: the cut scan can't be run together with the control regions" << std::endl;
+      exit(1);
     }
+    if(cutScanOnly) scanner = new CutScanner(this, filespace+"Scan_info.in");
+    else wantsCutScan = true;
   }
-
   initializeMCSelection(infiles);
+
+  ////trigger names, particles missing in a file, stitching branches and file statistics
+  FileHooks::get(BOOM).add(this, [this](TTree* tree) {newFile(tree);});
+
   initializeWkfactor(infiles);
+  setupEventWeights();
   setCutNeeds();
+  setSystDependencies();
   
   
 
@@ -347,7 +462,11 @@ void Analyzer::setupCR(std::string var, double val) {
 ////destructor
 Analyzer::~Analyzer() {
   clear_values();
-  delete BOOM;
+  if(ownsInput) {
+    FileHooks::release(BOOM);
+    BranchRegistry::release(BOOM);
+    delete BOOM;
+  } else FileHooks::get(BOOM).remove(this);
   delete _Electron;
   delete _Muon;
   delete _Tau;
@@ -377,9 +496,14 @@ Analyzer::~Analyzer() {
     delete it;
     it=nullptr;
   }
+  delete scanner;
+  delete bootstrap;
+  if(cutMaskOut != nullptr) {
+    cutMaskOut->close();
+    delete cutMaskOut;
+  }
 
   for(int i=0; i < nTrigReq; i++) {
-    delete trigPlace[i];
     delete trigName[i];
   }
 
@@ -399,17 +523,8 @@ void Analyzer::clear_values() {
       it[e]->clear();
     }
   }
-  if(infoFile!=BOOM->GetFile()){
-    std::cout<<"New file!"<<std::endl;
-    infoFile=BOOM->GetFile();
-  }
-  if(version==1 && infoFile!=BOOM->GetFile()){
-    std::cout<<"New file! Will get the trigger info."<<std::endl;
-    infoFile=BOOM->GetFile();
-    BAAM= (TTree*) infoFile->Get("TNT/BAAM");
-    initializeTrigger();
-    infoFile->Close();
-  }
+  if(ownsInput) allocCounter.newEvent();
+  nPtOrders = 0;
 
 
   leadIndex=-1;
@@ -417,8 +532,23 @@ void Analyzer::clear_values() {
 }
 
 ///Function that does most of the work.  Calculates the number of each particle
-void Analyzer::preprocess(int event) {
-  BOOM->GetEntry(event);
+bool Analyzer::preprocess(int event) {
+  currentEvent = event;
+  fileEvents++;
+  if(ownsInput) {
+    ////stitched samples: the gen leptons and the weights decide first, the other branches are only
+    ////read for kept events
+    if(stitchMaxMass > 0 && _Gen != nullptr) {
+      readStitchBranches(event);
+      _Gen->init();
+      if(!select_mc_background()) {
+        clear_values();
+        return false;
+      }
+    }
+    BOOM->GetEntry(event);
+    BranchRegistry::get(BOOM).sync();
+  }
   for(Particle* ipart: allParticles){
     ipart->init();
   }
@@ -428,7 +558,7 @@ void Analyzer::preprocess(int event) {
   if(!select_mc_background()){
     //we will put nothing in good particles
     clear_values();
-    return;
+    return false;
   }
 
   pu_weight = (!isData && CalculatePUSystematics) ? hPU[(int)(nTruePU+1)] : 1.0;
@@ -445,11 +575,19 @@ void Analyzer::preprocess(int event) {
 
   //////Triggers and Vertices
   active_part->at(CUTS::eRVertex)->resize(bestVertices);
-  TriggerCuts(*(trigPlace[0]), *(trigName[0]), CUTS::eRTrig1);
-  TriggerCuts(*(trigPlace[1]), *(trigName[1]), CUTS::eRTrig2);
+  if(triggerMenu == nullptr) updateTriggerMenu();
+  decodeTriggers();
+  TriggerCuts(triggerMenu->masks[0], CUTS::eRTrig1);
+  TriggerCuts(triggerMenu->masks[1], CUTS::eRTrig2);
+
+  ////shifts of all the JES sources for all jets at once
+  if(nJesSources > 0) {
+    jetScaleRes.GetSourceShifts(_Jet->recoEta(), _Jet->recoPt(), jesUp, jesDown);
+  }
 
   ////check update met is ok
   for(size_t i=0; i < syst_names.size(); i++) {
+    if(systs.at(i).isWeight()) continue;
      //////Smearing
     smearLepton(*_Electron, CUTS::eGElec, _Electron->pstats["Smear"], distats["Electron_systematics"], i);
     smearLepton(*_Muon, CUTS::eGMuon, _Muon->pstats["Smear"], distats["Muon_systematics"], i);
@@ -462,6 +600,7 @@ void Analyzer::preprocess(int event) {
   }
 
   for(size_t i=0; i < syst_names.size(); i++) {
+    if(systs.at(i).isWeight()) continue;
     std::string systname = syst_names.at(i);
     for( auto part: allParticles) part->setCurrentP(i);
     _MET->setCurrentP(i);
@@ -469,13 +608,14 @@ void Analyzer::preprocess(int event) {
   }
   active_part = &goodParts;
   
-  if( event < 10 || ( event < 100 && event % 10 == 0 ) ||
+  if(ownsInput && ( event < 10 || ( event < 100 && event % 10 == 0 ) ||
     ( event < 1000 && event % 100 == 0 ) ||
     ( event < 10000 && event % 1000 == 0 ) ||
-    ( event >= 10000 && event % 10000 == 0 ) ) {
+    ( event >= 10000 && event % 10000 == 0 ) ) ) {
        std::cout << std::setprecision(2)<<event << " Events analyzed "<< static_cast<double>(event)/nentries*100. <<"% done"<<std::endl;
        std::cout << std::fixed;
   }
+  return true;
 }
 
 
@@ -490,19 +630,16 @@ void Analyzer::getGoodParticles(int syst){
 
   // // SET NUMBER OF RECO PARTICLES
   // // MUST BE IN ORDER: Muon/Electron, Tau, Jet
-  getGoodRecoLeptons(*_Electron, CUTS::eRElec1, CUTS::eGElec, _Electron->pstats["Elec1"],syst);
-  getGoodRecoLeptons(*_Electron, CUTS::eRElec2, CUTS::eGElec, _Electron->pstats["Elec2"],syst);
-  getGoodRecoLeptons(*_Muon, CUTS::eRMuon1, CUTS::eGMuon, _Muon->pstats["Muon1"],syst);
-  getGoodRecoLeptons(*_Muon, CUTS::eRMuon2, CUTS::eGMuon, _Muon->pstats["Muon2"],syst);
-  getGoodRecoLeptons(*_Tau, CUTS::eRTau1, CUTS::eGTau, _Tau->pstats["Tau1"],syst);
-  getGoodRecoLeptons(*_Tau, CUTS::eRTau2, CUTS::eGTau, _Tau->pstats["Tau2"],syst);
-
-  getGoodRecoJets(CUTS::eRBJet, _Jet->pstats["BJet"],syst);
-  getGoodRecoJets(CUTS::eRJet1, _Jet->pstats["Jet1"],syst);
-  getGoodRecoJets(CUTS::eRJet2, _Jet->pstats["Jet2"],syst);
-  getGoodRecoJets(CUTS::eRCenJet, _Jet->pstats["CentralJet"],syst);
-  getGoodRecoJets(CUTS::eR1stJet, _Jet->pstats["FirstLeadingJet"],syst);
-  getGoodRecoJets(CUTS::eR2ndJet, _Jet->pstats["SecondLeadingJet"],syst);
+  ////siblings (Elec1 and Elec2, ...) are selected together, cuts they share are done once per object
+  getGoodRecoLeptons(*_Electron, electronSelections, CUTS::eGElec, syst);
+  getGoodRecoLeptons(*_Muon, muonSelections, CUTS::eGMuon, syst);
+  getGoodRecoLeptons(*_Tau, tauSelections, CUTS::eGTau, syst);
+
+  ////BJet first, the other jets can remove them
+  getGoodRecoJets(bJetSelections, syst);
+  getGoodRecoJets(jetSelections, syst);
+  getLeadingJet(CUTS::eR1stJet, syst);
+  getLeadingJet(CUTS::eR2ndJet, syst);
 
   getGoodRecoFatJets(CUTS::eRWjet, _FatJet->pstats["Wjet"],syst);
   //  treatMuons_Met(systname);
@@ -544,6 +681,7 @@ void Analyzer::getGoodParticles(int syst){
 
 
 void Analyzer::fill_efficiency() {
+  if(cutScanOnly) return;
   //cut efficiency
   const std::vector<CUTS> goodGenLep={CUTS::eGElec,CUTS::eGMuon,CUTS::eGTau};
   //just the lepton 1 for now
@@ -551,12 +689,24 @@ void Analyzer::fill_efficiency() {
 
 
 
+  ////histogram names only made once
+  if(effNames.empty()) {
+    for(auto gen: goodGenLep) {
+      std::smatch mGen;
+      std::string tmps=particleCutMap.at(gen)->getName();
+      std::regex_match(tmps, mGen, genName_regex);
+      std::vector<std::string> names;
+      for(std::string prefix: {"eff_Reco_", "eff_"}) {
+        for(std::string var: {"Pt", "Eta", "Phi"}) names.push_back(prefix + std::string(mGen[1]) + var);
+      }
+      effNames.push_back(names);
+    }
+  }
+
   for(size_t igen=0;igen<goodGenLep.size();igen++){
     Particle* part =particleCutMap.at(goodGenLep[igen]);
     CUTS cut=goodRecoLep[igen];
-    std::smatch mGen;
-    std::string tmps=part->getName();
-    std::regex_match(tmps, mGen, genName_regex);
+    const std::vector<std::string>& names = effNames[igen];
     //loop over all gen leptons
     for(int iigen : *active_part->at(goodGenLep[igen])){
 
@@ -567,14 +717,14 @@ void Analyzer::fill_efficiency() {
           foundReco=ireco;
         }
       }
-      histo.addEffiency("eff_Reco_"+std::string(mGen[1])+"Pt", _Gen->pt(iigen), foundReco>=0,0);
-      histo.addEffiency("eff_Reco_"+std::string(mGen[1])+"Eta",_Gen->eta(iigen),foundReco>=0,0);
-      histo.addEffiency("eff_Reco_"+std::string(mGen[1])+"Phi",_Gen->phi(iigen),foundReco>=0,0);
+      histo.addEffiency(names[0], _Gen->pt(iigen), foundReco>=0,0);
+      histo.addEffiency(names[1],_Gen->eta(iigen),foundReco>=0,0);
+      histo.addEffiency(names[2],_Gen->phi(iigen),foundReco>=0,0);
       if(foundReco>=0){
         bool id_particle= (find(active_part->at(cut)->begin(),active_part->at(cut)->end(),foundReco)!=active_part->at(cut)->end());
-        histo.addEffiency("eff_"+std::string(mGen[1])+"Pt", _Gen->pt(iigen), id_particle,0);
-        histo.addEffiency("eff_"+std::string(mGen[1])+"Eta",_Gen->eta(iigen),id_particle,0);
-        histo.addEffiency("eff_"+std::string(mGen[1])+"Phi",_Gen->phi(iigen),id_particle,0);
+        histo.addEffiency(names[3], _Gen->pt(iigen), id_particle,0);
+        histo.addEffiency(names[4],_Gen->eta(iigen),id_particle,0);
+        histo.addEffiency(names[5],_Gen->phi(iigen),id_particle,0);
       }
     }
   }
@@ -620,12 +770,14 @@ bool Analyzer::fillCuts(bool fillCounter) {
   bool prevTrue = true;
 
   maxCut=0;
+  cutMask=0;
   //  std::cout << active_part << std::endl;;
 
   for(size_t i = 0; i < cut_order->size(); i++) {
     std::string cut = cut_order->at(i);
     if(isData && cut.find("Gen") != std::string::npos){
       maxCut += 1;
+      cutMask |= 1ULL << i;
       continue;
     }
     int min= cut_info->at(cut).first;
@@ -638,6 +790,7 @@ bool Analyzer::fillCuts(bool fillCounter) {
         prevTrue = false;
         continue;  ////dirty dirty hack
       }
+      cutMask |= 1ULL << i;
       if(fillCounter && crbins == 1) {
         cuts_per[i]++;
         cuts_cumul[i] += (prevTrue) ? 1 : 0;
@@ -705,17 +858,34 @@ void Analyzer::printCuts() {
     else {
       std::cout << std::setw(10) << cuts_per.at(i) << "  ( " << std::setw(5) << ((float)cuts_per.at(i)) / nentries << ") ";
       if(crbins == 1) std::cout << std::setw(12) << cuts_cumul.at(i) << "  ( " << std::setw(5) << ((float)cuts_cumul.at(i)) / nentries << ") ";
+      if(crbins == 1 && bootstrap != nullptr) std::cout << " +- " << std::setw(8) << bootstrap->cumulativeRMS(i);
 
       std::cout << std::endl;
     }
   }
   std::cout << "---------------------------------------------------------------------------\n";
+  if(ownsInput) {
+    printFileStats();
+    BranchRegistry::get(BOOM).printLazyStats(nentries);
+    allocCounter.print();
+  }
 
   //write all the histograms
   //attention this is not the fill_histogram method from the Analyser
+  if(scanner != nullptr) {
+    scanner->write(histo.outname);
+    std::cout << "Cut scan written to " << histo.outname << ", the cut flow above uses the loosest scan thresholds" << std::endl;
+    return;
+  }
   histo.fill_histogram();
   if(doSystematics)
     syst_histo.fill_histogram();
+  if(doNMinusOne)
+    nminus1_histo.fill_histogram("NMinus1");
+  if(bootstrap != nullptr)
+    bootstrap->write(histo.outname, *histo.get_cutorder());
+  eventWeights.print();
+  eventWeights.write(histo.outname);
 
 }
 
@@ -723,57 +893,80 @@ void Analyzer::printCuts() {
 
 
 bool Analyzer::select_mc_background(){
-  //will return true if Z* mass is smaller than 200GeV
-  if(_Gen == nullptr){
+  //will return true if the Z* mass is smaller than the one of the stitching rule
+  if(_Gen == nullptr || stitchMaxMass < 0){
     return true;
   }
-  if(gen_selection["DY_noMass_gt_200"]){
-    TLorentzVector lep1;
-    TLorentzVector lep2;
-    for(size_t i=0; i<_Gen->size(); i++){
-      if(abs(_Gen->pdg_id->at(i))==11 or abs(_Gen->pdg_id->at(i))==13 or abs(_Gen->pdg_id->at(i))==15){
-        if(lep1!=TLorentzVector(0,0,0,0)){
-          lep2= _Gen->p4(i);
-          return (lep1+lep2).M()<200;
-        }else{
-          lep1= _Gen->p4(i);
-        }
-      }
+  int lep1 = -1;
+  for(size_t i=0; i<_Gen->size(); i++){
+    int pdg = abs(_Gen->pdg_id->at(i));
+    if(pdg != 11 && pdg != 13 && pdg != 15) continue;
+    if(lep1 < 0) lep1 = i;
+    else return (_Gen->p4(lep1) + _Gen->p4(i)).M() < stitchMaxMass;
+  }
+  //cout<<"could not find gen selection particle"<<std::endl;
+  return true;
+}
+
+////reads only the gen branches select_mc_background needs, for the current tree of the chain
+////the branches are found again for every file in newFile
+void Analyzer::readStitchBranches(int event) {
+  Long64_t local = BOOM->LoadTree(event);
+  if(local < 0) return;
+  for(auto branch: stitchBranches) branch->GetEntry(local);
+  BranchRegistry::get(BOOM).sync();
+}
+
+////called by FileHooks when the chain opens a new file: everything that depends on the file is
+////redone here or marked to be redone, nothing is checked per event
+void Analyzer::newFile(TTree* tree) {
+  triggerMenu = nullptr;
+  for(Particle* ipart: allParticles) ipart->checkBranches(tree);
+
+  stitchBranches.clear();
+  if(stitchMaxMass > 0) {
+    ////the weight branches too, rejected events are still counted in FillRun (fill_Rejected)
+    for(std::string name: {"Gen_pt", "Gen_eta", "Gen_phi", "Gen_energy", "Gen_pdg_id", "weightevt", "nTruePUInteractions"}) {
+      TBranch* branch = tree->GetBranch(name.c_str());
+      if(branch != nullptr) stitchBranches.push_back(branch);
     }
   }
-  //will return true if Z* mass is smaller than 200GeV
-  if(gen_selection["DY_noMass_gt_100"]){
-    TLorentzVector lep1;
-    TLorentzVector lep2;
-    for(size_t i=0; i<_Gen->size(); i++){
-      if(abs(_Gen->pdg_id->at(i))==11 or abs(_Gen->pdg_id->at(i))==13 or abs(_Gen->pdg_id->at(i))==15){
-        if(lep1!=TLorentzVector(0,0,0,0)){
-          lep2= _Gen->p4(i);
-          return (lep1+lep2).M()<100;
-        }else{
-          lep1= _Gen->p4(i);
-        }
-      }
+
+  if(useBootstrap) {
+    bootstrapLeaf = tree->GetLeaf(bootstrapBranch.c_str());
+    if(bootstrapLeaf == nullptr) {
+      std::cout << "ERROR: no branch " << bootstrapBranch << " to seed the bootstrap replicas in this file" << std::endl;
+      exit(1);
     }
   }
-  //cout<<"Something is rotten in the state of Denmark."<<std::endl;
-  //cout<<"could not find gen selection particle"<<std::endl;
-  return true;
+
+  if(!ownsInput) return;
+  printFileStats();
+  fileName = (BOOM->GetFile() != nullptr) ? BOOM->GetFile()->GetName() : "";
+  fileEvents = 0;
+  fileStart = std::chrono::system_clock::now();
+  std::cout<<"New file! "<<fileName<<std::endl;
+}
+
+void Analyzer::printFileStats() {
+  if(fileEvents == 0) return;
+  std::chrono::duration<double> seconds = std::chrono::system_clock::now() - fileStart;
+  std::cout << "File " << fileName << ": " << fileEvents << " events in " << seconds.count() << " s" << std::endl;
 }
 
 
-double Analyzer::getTauDataMCScaleFactor(int updown){
-  double sf=1.;
-  //for(size_t i=0; i<_Tau->size();i++){
+////nominal, up and down tau ID scale factor in one loop over the taus
+void Analyzer::getTauDataMCScaleFactors(double& nominal, double& up, double& down){
+  nominal = up = down = 1.;
+  const double sf = _Tau->pstats["Smear"].dmap.at("TauSF");
   for(auto i : *active_part->at(CUTS::eRTau1)){
     if(matchTauToGen(_Tau->p4(i),0.4)!=TLorentzVector()){
-
-      if(updown==-1) sf*=  _Tau->pstats["Smear"].dmap.at("TauSF") * (1.-(0.35*_Tau->pt(i)/1000.0));
-      else if(updown==0) sf*=  _Tau->pstats["Smear"].dmap.at("TauSF");
-      else if(updown==1) sf*=  _Tau->pstats["Smear"].dmap.at("TauSF") * (1.+(0.05*_Tau->pt(i)/1000.0));
+      double pt = _Tau->pt(i);
+      nominal *= sf;
+      up *= sf * (1.+(0.05*pt/1000.0));
+      down *= sf * (1.-(0.35*pt/1000.0));
     }
   }
-  return sf;
 }
 
 ///Calculates met from values from each file plus smearing and treating muons as neutrinos
@@ -899,85 +1092,100 @@ void Analyzer::setupGeneral() {
   read_info(filespace + "Run_info.in");
   read_info(filespace + "Systematics_info.in");
 
+  ////the trigger names are read per file in updateTriggerMenu
   if( BOOM->GetListOfBranches()->FindObject("Trigger_names") ==0){
     SetBranch("Trigger_decision", Trigger_decisionV1);
-    infoFile=BOOM->GetFile();
-    BAAM= (TTree*) infoFile->Get("TNT/BAAM");
-    initializeTrigger();
-    infoFile->Close();
     version=1;
   }else{
-    SetBranch("Trigger_names", Trigger_names);
+    Trigger_namesV2.bind(BOOM, "Trigger_names");
     SetBranch("Trigger_decision", Trigger_decision);
-    BOOM->GetEntry(0);
-    for(int i = 0; i < nTrigReq; i++) {
-      for(int j = 0; j < (int)trigName[i]->size(); j++) {
-        for(int k = 0; k < (int)Trigger_names->size(); k++) {
-          if(Trigger_names->at(k).find(trigName[i]->at(j)) != std::string::npos) {
-            // structure: i tigger 1 or 2 | j  name of trigger in trigger one or two
-            trigPlace[i]->at(j) = k;
-            break;
-          }
-        }
-      }
-    }
-    BOOM->SetBranchStatus("Trigger_names", 0);
   }
 }
 
 
-//get the correct trigger position:
-void Analyzer::initializeTrigger() {
-  BAAM->SetBranchStatus("triggernames", 1);
-  BAAM->SetBranchAddress("triggernames", &Trigger_names);
+////trigger names of the current file (from TNT/BAAM in version 1), the bits of the requested
+////triggers are only searched for the first time a menu is seen
+void Analyzer::updateTriggerMenu() {
+  const std::vector<std::string>* names = nullptr;
+  if(version == 1) {
+    BAAM = (TTree*) BOOM->GetFile()->Get("TNT/BAAM");
+    if(BAAM == nullptr) {
+      std::cout << "ERROR: no TNT/BAAM with the trigger names in " << BOOM->GetFile()->GetName() << std::endl;
+      exit(1);
+    }
+    BAAM->SetBranchStatus("triggernames", 1);
+    BAAM->SetBranchAddress("triggernames", &Trigger_names);
+    BAAM->GetEntry(0);
+    names = Trigger_names;
+  } else {
+    names = Trigger_namesV2.get();
+  }
 
-  BAAM->GetEntry(0);
-  for(int i = 0; i < nTrigReq; i++) {
-    for(int j = 0; j < (int)trigName[i]->size(); j++) {
-      for(int k = 0; k < (int)Trigger_names->size(); k++) {
-        if(Trigger_names->at(k).find(trigName[i]->at(j)) != std::string::npos) {
-          trigPlace[i]->at(j) = k;
-          break;
+  std::string joined;
+  for(auto& name: *names) joined += name + '\n';
+  size_t hash = std::hash<std::string>()(joined);
+  auto found = triggerMenus.find(hash);
+  if(found == triggerMenus.end() || found->second.names != *names) {
+    TriggerMenu& menu = triggerMenus[hash];
+    menu.names = *names;
+    for(int i = 0; i < nTrigReq; i++) {
+      menu.masks[i].assign((names->size() + 63)/64, 0);
+      for(auto& requested: *trigName[i]) {
+        ////first trigger containing the requested name
+        size_t k = 0;
+        while(k < names->size() && names->at(k).find(requested) == std::string::npos) k++;
+        if(k == names->size()) {
+          std::cout << "Warning: trigger " << requested << " is not in the trigger names of this file" << std::endl;
+          continue;
         }
+        menu.masks[i][k/64] |= uint64_t(1) << (k%64);
       }
     }
+    found = triggerMenus.find(hash);
   }
-  BAAM->SetBranchStatus("triggernames", 0);
+  triggerMenu = &found->second;
 }
 
-void Analyzer::initializeMCSelection(std::vector<std::string> infiles) {
-    // check if we need to make gen level cuts to cross clean the samples:
-
-  isVSample = false;
-  if(infiles[0].find("DY") != std::string::npos){
-    isVSample = true;
-    if(infiles[0].find("DYJetsToLL_M-50_HT-") != std::string::npos){
-      gen_selection["DY_noMass_gt_100"]=true;
-      //gen_selection["DY_noMass_gt_200"]=true;
-    //get the DY1Jet DY2Jet ...
-    }else if(infiles[0].find("JetsToLL_TuneCUETP8M1_13TeV") != std::string::npos){
-      gen_selection["DY_noMass_gt_100"]=true;
-    }else{
-      //set it to false!!
-      gen_selection["DY_noMass_gt_100"]=false;
-      gen_selection["DY_noMass_gt_200"]=false;
+////fired triggers of the event as bits of the trigger names
+void Analyzer::decodeTriggers() {
+  firedTriggers.assign(triggerMenu->masks[0].size(), 0);
+  size_t nbits = firedTriggers.size()*64;
+  if(version == 1) {
+    ////list of the fired triggers
+    for(int k: *Trigger_decisionV1) {
+      if(k >= 0 && (size_t)k < nbits) firedTriggers[k/64] |= uint64_t(1) << (k%64);
     }
-
-    if(infiles[0].find("DYJetsToLL_M-50_TuneCUETP8M1_13TeV") != std::string::npos){
-      gen_selection["DY_noMass_gt_100"]=true;
-    }else{
-      //set it to false!!
-      gen_selection["DY_noMass_gt_100"]=false;
-      gen_selection["DY_noMass_gt_200"]=false;
+  } else {
+    size_t n = std::min(nbits, Trigger_decision->size());
+    for(size_t k = 0; k < n; k++) {
+      if(Trigger_decision->at(k) == 1) firedTriggers[k/64] |= uint64_t(1) << (k%64);
     }
-  }else{
-    //set it to false!!
-    gen_selection["DY_noMass_gt_200"]=false;
-    gen_selection["DY_noMass_gt_100"]=false;
   }
+}
 
-  if(infiles[0].find("WJets") != std::string::npos){
-    isVSample = true;
+////stitching of inclusive samples with the mass binned ones: events of a file matching 'sample'
+////are only kept if the first two gen leptons have a mass below maxMass.  The first rule that
+////matches is used.
+struct StitchRule {
+  std::string sample;
+  std::string name;
+  double maxMass;
+};
+static const std::vector<StitchRule> stitchRules = {
+  {"DYJetsToLL_M-50_TuneCUETP8M1_13TeV", "DY_noMass_gt_100", 100.},
+};
+
+void Analyzer::initializeMCSelection(std::vector<std::string> infiles) {
+    // check if we need to make gen level cuts to cross clean the samples:
+
+  isVSample = infiles[0].find("DY") != std::string::npos || infiles[0].find("WJets") != std::string::npos;
+  stitchMaxMass = -1;
+  if(isData) return;
+  for(auto& rule: stitchRules) {
+    if(infiles[0].find(rule.sample) == std::string::npos) continue;
+    stitchMaxMass = rule.maxMass;
+    std::cout<<"Waning: The selection "<< rule.name<< " is active!"<<std::endl;
+    break;
   }
 }
 
@@ -1015,7 +1223,6 @@ void Analyzer::read_info(std::string filename) {
       if(stemp.at(0).find("Trigger") != std::string::npos) {
         int ntrig = (stemp.at(0).find("1") != std::string::npos) ? 0 : 1;
         trigName[ntrig]->push_back(stemp.at(1));
-        trigPlace[ntrig]->push_back(0);
         continue;
       }
 
@@ -1077,33 +1284,33 @@ void Analyzer::setCutNeeds() {
     neededCuts.loadCuts(_FatJet->overlapCuts(CUTS::eRWjet));
   } else {
     std::cout<<"WJets not needed. They will be deactivated!"<<std::endl;
-    _FatJet->unBranch();
+    unBranch(_FatJet);
   }
 
   if( neededCuts.isPresent(CUTS::eRTau1) || neededCuts.isPresent(CUTS::eRTau2) ) {
     neededCuts.loadCuts(_Tau->findExtraCuts());
   } else {
     std::cout<<"Taus not needed. They will be deactivated!"<<std::endl;
-    _Tau->unBranch();
+    unBranch(_Tau);
   }
 
   if( neededCuts.isPresent(CUTS::eRElec1) || neededCuts.isPresent(CUTS::eRElec2) ) {
     neededCuts.loadCuts(_Electron->findExtraCuts());
   } else {
     std::cout<<"Electrons not needed. They will be deactivated!"<<std::endl;
-    _Electron->unBranch();
+    unBranch(_Electron);
   }
 
   if( neededCuts.isPresent(CUTS::eRMuon1) || neededCuts.isPresent(CUTS::eRMuon2) ) {
     neededCuts.loadCuts(_Muon->findExtraCuts());
   } else {
     std::cout<<"Muons not needed. They will be deactivated!"<<std::endl;
-    _Muon->unBranch();
+    unBranch(_Muon);
   }
 
   if( !neededCuts.isPresent(CUTS::eGen) and !isData) {
     std::cout<<"Gen not needed. They will be deactivated!"<<std::endl;
-    _Gen->unBranch();
+    unBranch(_Gen);
 
   }
 
@@ -1115,6 +1322,56 @@ void Analyzer::setCutNeeds() {
 }
 
 
+////branches are only switched off by the configuration that reads the chain, the
+////other configurations switch back on whatever they bind, so the union stays active
+////dependencies between the selections beyond the fixed ones of DepGraph (overlap removal, MET),
+////used to find the selections every systematic can change
+void Analyzer::setSystDependencies() {
+  std::vector<std::pair<CUTS, CUTS> > dependencies = neededCuts.getDependencies();
+
+  for(auto it: jetCuts) {
+    for(auto overlap: _Jet->overlapCuts(it)) dependencies.push_back(std::make_pair(it, overlap));
+    if(it != CUTS::eRBJet && _Jet->pstats["BJet"].bfind("RemoveBJetsFromJets")) dependencies.push_back(std::make_pair(it, CUTS::eRBJet));
+  }
+  dependencies.push_back(std::make_pair(CUTS::eR1stJet, CUTS::eRJet1));
+  dependencies.push_back(std::make_pair(CUTS::eR2ndJet, CUTS::eRJet1));
+  for(auto overlap: _FatJet->overlapCuts(CUTS::eRWjet)) dependencies.push_back(std::make_pair(CUTS::eRWjet, overlap));
+
+  const std::vector<std::pair<CUTS, PartStats*> > leptons = {
+    {CUTS::eRElec1, &_Electron->pstats["Elec1"]}, {CUTS::eRElec2, &_Electron->pstats["Elec2"]},
+    {CUTS::eRMuon1, &_Muon->pstats["Muon1"]}, {CUTS::eRMuon2, &_Muon->pstats["Muon2"]},
+    {CUTS::eRTau1, &_Tau->pstats["Tau1"]}, {CUTS::eRTau2, &_Tau->pstats["Tau2"]}
+  };
+  for(auto& lep: leptons) {
+    for(auto& overlap: overlapNames) {
+      if(lep.second->bfind(overlap.first)) dependencies.push_back(std::make_pair(lep.first, overlap.second));
+    }
+    if(lep.second->bfind("DiscrByMetDphi") || lep.second->bfind("DiscrByMetMt")) dependencies.push_back(std::make_pair(lep.first, CUTS::eMET));
+  }
+
+  const std::vector<std::pair<CUTS, std::string> > combos = {
+    {CUTS::eElec1Tau1, "Electron1Tau1"}, {CUTS::eElec2Tau1, "Electron2Tau1"}, {CUTS::eElec1Tau2, "Electron1Tau2"}, {CUTS::eElec2Tau2, "Electron2Tau2"},
+    {CUTS::eMuon1Tau1, "Muon1Tau1"}, {CUTS::eMuon1Tau2, "Muon1Tau2"}, {CUTS::eMuon2Tau1, "Muon2Tau1"}, {CUTS::eMuon2Tau2, "Muon2Tau2"},
+    {CUTS::eMuon1Elec1, "Muon1Electron1"}, {CUTS::eMuon1Elec2, "Muon1Electron2"}, {CUTS::eMuon2Elec1, "Muon2Electron1"}, {CUTS::eMuon2Elec2, "Muon2Electron2"},
+    {CUTS::eDiTau, "DiTau"}, {CUTS::eDiElec, "DiElectron"}, {CUTS::eDiMuon, "DiMuon"}
+  };
+  for(auto& combo: combos) {
+    const PartStats& stats = distats[combo.second];
+    bool metMass = stats.bfind("DiscrByMassReco") && stats.smap.find("HowCalculateMassReco") != stats.smap.end()
+      && stats.smap.at("HowCalculateMassReco") != "InvariantMass";
+    if(metMass || stats.bfind("DiscrByCDFzeta2D") || stats.bfind("DiscrByCosDphiPtAndMet")) dependencies.push_back(std::make_pair(combo.first, CUTS::eMET));
+  }
+  dependencies.push_back(std::make_pair(CUTS::eSusyCom, CUTS::eMET));
+
+  systs.propagate(dependencies);
+}
+
+void Analyzer::unBranch(Particle* part) {
+  if(!ownsInput) return;
+  part->unBranch();
+}
+
+
 ///Smears lepton only if specified and not a data file.  Otherwise, just filles up lorentz std::vectors
 //of the data into the std::vector container smearP with is in each lepton object.
 void Analyzer::smearLepton(Lepton& lep, CUTS eGenPos, const PartStats& stats, const PartStats& syst_stats, int syst) {
@@ -1123,13 +1380,13 @@ void Analyzer::smearLepton(Lepton& lep, CUTS eGenPos, const PartStats& stats, co
     return;
   }
 
-  std::string systname = syst_names.at(syst);
+  const SystDescriptor& desc = systs.at(syst);
   if(!lep.needSyst(syst)) return;
 
-  if(systname=="orig" && !stats.bfind("SmearTheParticle")){
+  if(desc.isNominal() && !stats.bfind("SmearTheParticle")){
     lep.setOrigReco();
   } else {
-    systematics.loadScaleRes(stats, syst_stats, systname);
+    systematics.loadScaleRes(stats, syst_stats, desc);
     for(size_t i = 0; i < lep.size(); i++) {
       TLorentzVector lepReco = lep.RecoP4(i);
       TLorentzVector genVec =  matchLeptonToGen(lepReco, lep.pstats["Smear"],eGenPos);
@@ -1152,7 +1409,7 @@ void Analyzer::smearJet(Particle& jet, const CUTS eGenPos, const PartStats& stat
   //add energy scale uncertainty
 
 
-  std::string systname = syst_names.at(syst);
+  const SystDescriptor& desc = systs.at(syst);
 
   for(size_t i=0; i< jet.size(); i++) {
     TLorentzVector jetReco = jet.RecoP4(i);
@@ -1167,18 +1424,16 @@ void Analyzer::smearJet(Particle& jet, const CUTS eGenPos, const PartStats& stat
     //only apply corrections for jets not for FatJets
 
     TLorentzVector genJet=matchJetToGen(jetReco, jet.pstats["Smear"],eGenPos);
-    if(systname=="orig" && stats.bfind("SmearTheJet")){
+    if(desc.isNominal() && stats.bfind("SmearTheJet")){
       sf=jetScaleRes.GetRes(jetReco,genJet, rho, 0);
-    }else if(systname=="Jet_Res_Up"){
-      sf=jetScaleRes.GetRes(jetReco,genJet, rho, 1);
-    }else if(systname=="Jet_Res_Down"){
-      sf=jetScaleRes.GetRes(jetReco,genJet, rho, -1);
-    }else if(systname=="Jet_Scale_Up"){
-      sf = jetScaleRes.GetScale(jetReco, false, +1.);
-    }else if(systname=="Jet_Scale_Down"){
-      sf = jetScaleRes.GetScale(jetReco, false, -1) ;
-    }
-    //cout<<systname<<"  "<<sf<<"  "<<jetReco.Pt()<<"  "<<genJet.Pt()<<std::endl;
+    }else if(desc.kind == SystKind::Resolution){
+      sf=jetScaleRes.GetRes(jetReco,genJet, rho, desc.direction);
+    }else if(desc.kind == SystKind::Scale && desc.jesSource < 0){
+      sf = jetScaleRes.GetScale(jetReco, false, desc.direction);
+    }else if(desc.kind == SystKind::Scale){
+      sf = (desc.direction > 0) ? 1. + jesUp[i*nJesSources+desc.jesSource] : 1. - jesDown[i*nJesSources+desc.jesSource];
+    }
+    //cout<<desc.name<<"  "<<sf<<"  "<<jetReco.Pt()<<"  "<<genJet.Pt()<<std::endl;
     systematics.shiftParticle(jet, jetReco, sf, _MET->systdeltaMEx[syst], _MET->systdeltaMEy[syst], syst);
   }
 }
@@ -1301,152 +1556,393 @@ void Analyzer::getGoodTauNu() {
 }
 
 ///Function used to find the number of reco leptons that pass the various cuts.
-///Divided into if blocks for the different lepton requirements.
-void Analyzer::getGoodRecoLeptons(const Lepton& lep, const CUTS ePos, const CUTS eGenPos, const PartStats& stats, const int syst) {
-  if(! neededCuts.isPresent(ePos)) return;
+///All selections of the group (Elec1 and Elec2, ...) are made in one pass over the leptons.
+template <class T>
+void Analyzer::getGoodRecoLeptons(const T& lep, SiblingGroup& group, const CUTS eGenPos, const int syst) {
+  bool matchToGen = lep.pstats.at("Smear").bfind("MatchToGen") && !isData;
+  if(!group.built) buildLeptonGroup(group, lep.type, matchToGen);
+
+  size_t nsiblings = group.ePos.size();
+  bool anyActive = false;
+  for(size_t s = 0; s < nsiblings; s++) {
+    CUTS ePos = group.ePos[s];
+    const PartStats& stats = *group.stats[s];
+    group.active[s] = false;
+    group.reuse[s] = false;
+    if(! neededCuts.isPresent(ePos)) continue;
+    if(!systs.at(syst).affects(ePos)) {
+      active_part->at(ePos) = goodParts[ePos];
+      continue;
+    }
 
-  std::string systname = syst_names.at(syst);
-  if(!lep.needSyst(syst)) {
-    active_part->at(ePos) = goodParts[ePos];
-    return;
+    ////only the pt cut can change under a rescaling, the other cuts use the direction or fixed values.
+    ////Electron and muon isolation is relative to the (shifted) pt, so it has to be evaluated again.
+    NominalSelection& nominal = *group.nominals[s];
+    if(syst == 0) {
+      nominal.clear();
+      nominal.reusable = reuseNominal && !stats.bfind("DiscrIfIsZdecay") && !stats.bfind("DiscrByMetDphi") && !stats.bfind("DiscrByMetMt")
+        && !matchToGen && !(lep.type != PType::Tau && stats.bfind("DoDiscrByIsolation"));
+    } else group.reuse[s] = nominal.reusable && overlapsUnchanged(stats);
+    group.active[s] = true;
+    anyActive = true;
   }
+  if(!anyActive) return;
 
   int i = 0;
   for(auto lvec: lep) {
-    bool passCuts = true;
-    if (fabs(lvec.Eta()) > stats.dmap.at("EtaCut")) passCuts = passCuts && false;
-    else if (lvec.Pt() < stats.pmap.at("PtCut").first || lvec.Pt() > stats.pmap.at("PtCut").second) passCuts = passCuts && false;
-
-    if((lep.pstats.at("Smear").bfind("MatchToGen")) && (!isData)) {   /////check
-      if(matchLeptonToGen(lvec, lep.pstats.at("Smear") ,eGenPos) == TLorentzVector(0,0,0,0)) continue;
-    }
-
-    for( auto cut: stats.bset) {
-      if(!passCuts) break;
-      else if(cut == "DoDiscrByIsolation") {
-        double firstIso = (stats.pmap.find("IsoSumPtCutValue") != stats.pmap.end()) ? stats.pmap.at("IsoSumPtCutValue").first : ival(ePos) - ival(CUTS::eRTau1) + 1;
-        double secondIso = (stats.pmap.find("IsoSumPtCutValue") != stats.pmap.end()) ? stats.pmap.at("IsoSumPtCutValue").second : stats.bfind("FlipIsolationRequirement");
-        passCuts = passCuts && lep.get_Iso(i, firstIso, secondIso);
-      }
-      else if(cut == "DiscrIfIsZdecay" && lep.type != PType::Tau ) passCuts = passCuts && isZdecay(lvec, lep);
-      else if(cut == "DiscrByMetDphi") passCuts = passCuts && passCutRange(absnormPhi(lvec.Phi() - _MET->phi()), stats.pmap.at("MetDphiCut"));
-      else if(cut == "DiscrByMetMt") passCuts = passCuts && passCutRange(calculateLeptonMetMt(lvec), stats.pmap.at("MetMtCut"));
-      /////muon cuts
-      else if(lep.type == PType::Muon){
-        if(cut == "DoDiscrByTightID") passCuts = passCuts && _Muon->tight->at(i);
-        else if(cut == "DoDiscrBySoftID") passCuts = passCuts && _Muon->soft->at(i);
-      }
-      ////electron cuts
-      else if(lep.type == PType::Electron){
-        if(cut == "DoDiscrByVetoID") passCuts = passCuts && _Electron->isPassVeto->at(i);
-        else if(cut == "DoDiscrByLooseID" ) passCuts = passCuts && _Electron->isPassLoose->at(i);
-        else if(cut == "DoDiscrByMediumID") passCuts = passCuts && _Electron->isPassMedium->at(i);
-        else if(cut == "DoDiscrByTightID" ) passCuts = passCuts && _Electron->isPassTight->at(i);
-        else if(cut == "DoDiscrByHEEPID"  ) passCuts = passCuts && _Electron->isPassHEEPId->at(i);
-      }
-      else if(lep.type == PType::Tau){
-        if(cut == "DoDiscrByCrackCut") passCuts = passCuts && !isInTheCracks(lvec.Eta());
-        /////tau cuts
-        else if(cut == "DoDzCut") passCuts = passCuts && (_Tau->leadChargedCandDz_pv->at(i) <= stats.dmap.at("DzCutThreshold"));
-        else if(cut == "DoDiscrByLeadTrack") passCuts = passCuts && (_Tau->leadChargedCandPt->at(i) >= stats.dmap.at("LeadTrackThreshold"));
-             // ----Electron and Muon vetos
-        else if (cut == "DoDiscrAgainstElectron") passCuts = passCuts && _Tau->pass_against_Elec(ePos, i);
-        else if (cut == "SelectTausThatAreElectrons") passCuts = passCuts && !_Tau->pass_against_Elec(ePos, i);
-
-        else if (cut == "DoDiscrAgainstMuon") passCuts = passCuts && _Tau->pass_against_Muon(ePos, i);
-        else if (cut == "SelectTausThatAreMuons") passCuts = passCuts &&  !_Tau->pass_against_Muon(ePos, i);
-
-        else if(cut == "DiscrByProngType") {
-          passCuts = passCuts && (stats.smap.at("ProngType").find("hps") == std::string::npos || _Tau->decayModeFindingNewDMs->at(i) != 0);
-          passCuts = passCuts && passProng(stats.smap.at("ProngType"), _Tau->decayMode->at(i));
-        }
-        else if(cut == "decayModeFindingNewDMs") passCuts = passCuts && _Tau->decayModeFindingNewDMs->at(i) != 0;
-        else if(cut == "decayModeFinding") passCuts = passCuts && _Tau->decayModeFinding->at(i) != 0;
-              // ----anti-overlap requirements
-        else if(cut == "RemoveOverlapWithMuon1s") passCuts = passCuts && !isOverlaping(lvec, *_Muon, CUTS::eRMuon1, stats.dmap.at("Muon1MatchingDeltaR"));
-        else if(cut == "RemoveOverlapWithMuon2s") passCuts = passCuts && !isOverlaping(lvec, *_Muon, CUTS::eRMuon2, stats.dmap.at("Muon2MatchingDeltaR"));
-        else if(cut == "RemoveOverlapWithElectron1s") passCuts = passCuts && !isOverlaping(lvec, *_Electron, CUTS::eRElec1, stats.dmap.at("Electron1MatchingDeltaR"));
-        else if(cut == "RemoveOverlapWithElectron2s") passCuts = passCuts && !isOverlaping(lvec, *_Electron, CUTS::eRElec2, stats.dmap.at("Electron2MatchingDeltaR"));
+    group.newObject();
+    for(size_t s = 0; s < nsiblings; s++) {
+      if(!group.active[s]) continue;
+      CUTS ePos = group.ePos[s];
+      const PartStats& stats = *group.stats[s];
+      NominalSelection& nominal = *group.nominals[s];
+      if(group.reuse[s] && nominal.holds(i, lvec)) {
+        if(nominal.pass[i]) active_part->at(ePos)->push_back(i);
+        continue;
       }
-      else std::cout << "cut: " << cut << " not listed" << std::endl;
+      bool ptTested = fabs(lvec.Eta()) <= group.etaHigh[s];
+      bool passCuts = ptTested && lvec.Pt() >= group.ptLow[s] && lvec.Pt() <= group.ptHigh[s];
+
+      const std::vector<int>& cuts = group.codes[s];
+      passCuts = passCuts && group.orders[s]->pass([&](int k) {
+          return group.shared(s, k, [&]() {
+              switch(static_cast<LepCut>(cuts[k])) {
+              case LepCut::MatchToGen: return matchLeptonToGen(lvec, lep.pstats.at("Smear") ,eGenPos) != TLorentzVector(0,0,0,0);
+              case LepCut::Iso:        return lep.T::get_Iso(i, group.isoFirst[s], group.isoSecond[s]);
+              case LepCut::ZDecay:     return isZdecay(lvec, lep);
+              case LepCut::MetDphi:    return passCutRange(absnormPhi(lvec.Phi() - _MET->phi()), stats.pmap.at("MetDphiCut"));
+              case LepCut::MetMt:      return passCutRange(calculateLeptonMetMt(lvec), stats.pmap.at("MetMtCut"));
+              default:                 return passLeptonCut(lep, static_cast<LepCut>(cuts[k]), i, lvec, ePos, stats);
+              }
+            });
+        });
+      if(passCuts) active_part->at(ePos)->push_back(i);
+      if(syst == 0) nominal.record(lvec, passCuts, ptTested, group.ptLow[s], group.ptHigh[s]);
     }
-    if(passCuts) active_part->at(ePos)->push_back(i);
     i++;
   }
+}
 
-  return;
+////codes, shared slots and limits of the selections of a lepton group, read once
+void Analyzer::buildLeptonGroup(SiblingGroup& group, PType type, bool matchToGen) {
+  size_t nsiblings = group.ePos.size();
+  group.codes.assign(nsiblings, std::vector<int>());
+  group.slots.assign(nsiblings, std::vector<int>());
+  group.active.assign(nsiblings, false);
+  group.reuse.assign(nsiblings, false);
+  for(size_t s = 0; s < nsiblings; s++) {
+    CUTS ePos = group.ePos[s];
+    const PartStats& stats = *group.stats[s];
+    for(auto cut: leptonCuts(ePos, type, stats, matchToGen)) {
+      group.codes[s].push_back(static_cast<int>(cut));
+      group.slots[s].push_back(group.slot(leptonCutKey(cut, ePos, stats)));
+    }
+    group.etaHigh.push_back(stats.dmap.at("EtaCut"));
+    group.ptLow.push_back(stats.pmap.at("PtCut").first);
+    group.ptHigh.push_back(stats.pmap.at("PtCut").second);
+    bool isoRange = stats.pmap.find("IsoSumPtCutValue") != stats.pmap.end();
+    group.isoFirst.push_back(isoRange ? stats.pmap.at("IsoSumPtCutValue").first : ival(ePos) - ival(CUTS::eRTau1) + 1);
+    group.isoSecond.push_back(isoRange ? stats.pmap.at("IsoSumPtCutValue").second : stats.bfind("FlipIsolationRequirement"));
+    group.nominals.push_back(&nominalSelection[ePos]);
+    group.orders.push_back(&cutOrders[ePos]);
+  }
+  group.built = true;
 }
 
-////Jet specific function for finding the number of jets that pass the cuts.
-//used to find the nubmer of good jet1, jet2, central jet, 1st and 2nd leading jets and bjet.
-void Analyzer::getGoodRecoJets(CUTS ePos, const PartStats& stats, const int syst) {
+////cut value in a sibling key, exact so only identical values share a slot
+static std::string num(double value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.17g", value);
+  return std::string(buffer);
+}
 
-  if(! neededCuts.isPresent(ePos)) return;
+////cuts of two siblings with the same key give the same answer for an object
+std::string Analyzer::leptonCutKey(LepCut cut, CUTS ePos, const PartStats& stats) {
+  std::string key = std::to_string(static_cast<int>(cut));
+  switch(cut) {
+  case LepCut::Iso: {
+    bool isoRange = stats.pmap.find("IsoSumPtCutValue") != stats.pmap.end();
+    if(isoRange) return key + " " + num(stats.pmap.at("IsoSumPtCutValue").first) + " " + num(stats.pmap.at("IsoSumPtCutValue").second);
+    return key + " " + num(ival(ePos) - ival(CUTS::eRTau1) + 1) + " " + num(stats.bfind("FlipIsolationRequirement"));
+  }
+  case LepCut::MetDphi:      return key + " " + num(stats.pmap.at("MetDphiCut").first) + " " + num(stats.pmap.at("MetDphiCut").second);
+  case LepCut::MetMt:        return key + " " + num(stats.pmap.at("MetMtCut").first) + " " + num(stats.pmap.at("MetMtCut").second);
+  case LepCut::TauDz:        return key + " " + num(stats.dmap.at("DzCutThreshold"));
+  case LepCut::TauLeadTrack: return key + " " + num(stats.dmap.at("LeadTrackThreshold"));
+  case LepCut::TauProng:     return key + " " + stats.smap.at("ProngType");
+    ////discriminators chosen per selection
+  case LepCut::TauAgainstElec: case LepCut::TauIsElec:
+  case LepCut::TauAgainstMuon: case LepCut::TauIsMuon:
+    return key + " " + std::to_string(static_cast<int>(ePos));
+  case LepCut::OverlapMuon1: return key + " " + num(stats.dmap.at("Muon1MatchingDeltaR"));
+  case LepCut::OverlapMuon2: return key + " " + num(stats.dmap.at("Muon2MatchingDeltaR"));
+  case LepCut::OverlapElec1: return key + " " + num(stats.dmap.at("Electron1MatchingDeltaR"));
+  case LepCut::OverlapElec2: return key + " " + num(stats.dmap.at("Electron2MatchingDeltaR"));
+  default: return key;
+  }
+}
 
-  std::string systname = syst_names.at(syst);
-  if(!_Jet->needSyst(syst)) {
-    active_part->at(ePos)=goodParts[ePos];
-    return;
+////cut names of the lepton info files, the ones not listed for a type are ignored (as before)
+const std::vector<Analyzer::LepCut>& Analyzer::leptonCuts(CUTS ePos, PType type, const PartStats& stats, bool matchToGen) {
+  auto found = leptonCutCodes.find(ePos);
+  if(found != leptonCutCodes.end()) return found->second;
+
+  static const std::unordered_map<std::string, LepCut> common = {
+    {"DoDiscrByIsolation", LepCut::Iso}, {"DiscrByMetDphi", LepCut::MetDphi}, {"DiscrByMetMt", LepCut::MetMt},
+  };
+  static const std::unordered_map<std::string, LepCut> muon = {
+    {"DiscrIfIsZdecay", LepCut::ZDecay}, {"DoDiscrByTightID", LepCut::MuonTightID}, {"DoDiscrBySoftID", LepCut::MuonSoftID},
+  };
+  static const std::unordered_map<std::string, LepCut> electron = {
+    {"DiscrIfIsZdecay", LepCut::ZDecay}, {"DoDiscrByVetoID", LepCut::ElecVetoID}, {"DoDiscrByLooseID", LepCut::ElecLooseID},
+    {"DoDiscrByMediumID", LepCut::ElecMediumID}, {"DoDiscrByTightID", LepCut::ElecTightID}, {"DoDiscrByHEEPID", LepCut::ElecHEEPID},
+  };
+  static const std::unordered_map<std::string, LepCut> tau = {
+    {"DoDiscrByCrackCut", LepCut::TauCrack}, {"DoDzCut", LepCut::TauDz}, {"DoDiscrByLeadTrack", LepCut::TauLeadTrack},
+    {"DoDiscrAgainstElectron", LepCut::TauAgainstElec}, {"SelectTausThatAreElectrons", LepCut::TauIsElec},
+    {"DoDiscrAgainstMuon", LepCut::TauAgainstMuon}, {"SelectTausThatAreMuons", LepCut::TauIsMuon},
+    {"DiscrByProngType", LepCut::TauProng}, {"decayModeFindingNewDMs", LepCut::TauNewDMs}, {"decayModeFinding", LepCut::TauDMF},
+    {"RemoveOverlapWithMuon1s", LepCut::OverlapMuon1}, {"RemoveOverlapWithMuon2s", LepCut::OverlapMuon2},
+    {"RemoveOverlapWithElectron1s", LepCut::OverlapElec1}, {"RemoveOverlapWithElectron2s", LepCut::OverlapElec2},
+  };
+  const std::unordered_map<std::string, LepCut>& specific = (type == PType::Muon) ? muon : (type == PType::Electron) ? electron : tau;
+
+  std::vector<LepCut>& codes = leptonCutCodes[ePos];
+  std::vector<std::string> names;
+  if(matchToGen) {
+    codes.push_back(LepCut::MatchToGen);
+    names.push_back("MatchToGen");
+  }
+  for(auto& cut: stats.bset) {
+    auto it = common.find(cut);
+    if(it == common.end() && (it = specific.find(cut)) == specific.end()) continue;
+    codes.push_back(it->second);
+    names.push_back(cut);
+  }
+  cutOrders[ePos].setCuts(cutName(ePos), names, cutOrderWarmup, pinnedCutOrder(stats));
+  return codes;
+}
+
+bool Analyzer::passLeptonCut(const Muon& muon, LepCut cut, int i, const TLorentzVector& lvec, CUTS ePos, const PartStats& stats) {
+  switch(cut) {
+  case LepCut::MuonTightID: return muon.passID(i, IDBit::MuonTight);
+  case LepCut::MuonSoftID:  return muon.passID(i, IDBit::MuonSoft);
+  default: return true;
   }
+}
 
-  int i=0;
+bool Analyzer::passLeptonCut(const Electron& elec, LepCut cut, int i, const TLorentzVector& lvec, CUTS ePos, const PartStats& stats) {
+  switch(cut) {
+  case LepCut::ElecVetoID:   return elec.passID(i, IDBit::ElecVeto);
+  case LepCut::ElecLooseID:  return elec.passID(i, IDBit::ElecLoose);
+  case LepCut::ElecMediumID: return elec.passID(i, IDBit::ElecMedium);
+  case LepCut::ElecTightID:  return elec.passID(i, IDBit::ElecTight);
+  case LepCut::ElecHEEPID:   return elec.passID(i, IDBit::ElecHEEP);
+  default: return true;
+  }
+}
 
-  for(auto lvec: *_Jet) {
-    if(ePos == CUTS::eR1stJet || ePos == CUTS::eR2ndJet){
-      break;
+bool Analyzer::passLeptonCut(const Taus& tau, LepCut cut, int i, const TLorentzVector& lvec, CUTS ePos, const PartStats& stats) {
+  switch(cut) {
+  case LepCut::TauCrack:       return !isInTheCracks(lvec.Eta());
+  case LepCut::TauDz:          return tau.leadChargedCandDz_pv->at(i) <= stats.dmap.at("DzCutThreshold");
+  case LepCut::TauLeadTrack:   return tau.leadChargedCandPt->at(i) >= stats.dmap.at("LeadTrackThreshold");
+    // ----Electron and Muon vetos
+  case LepCut::TauAgainstElec: return tau.pass_against_Elec(ePos, i);
+  case LepCut::TauIsElec:      return !tau.pass_against_Elec(ePos, i);
+  case LepCut::TauAgainstMuon: return tau.pass_against_Muon(ePos, i);
+  case LepCut::TauIsMuon:      return !tau.pass_against_Muon(ePos, i);
+  case LepCut::TauProng:
+    return (stats.smap.at("ProngType").find("hps") == std::string::npos || tau.passID(i, IDBit::TauNewDMs))
+      && passProng(stats.smap.at("ProngType"), tau.decayMode->at(i));
+  case LepCut::TauNewDMs:      return tau.passID(i, IDBit::TauNewDMs);
+  case LepCut::TauDMF:         return tau.passID(i, IDBit::TauDMF);
+    // ----anti-overlap requirements
+  case LepCut::OverlapMuon1:   return !isOverlaping(lvec, *_Muon, CUTS::eRMuon1, stats.dmap.at("Muon1MatchingDeltaR"));
+  case LepCut::OverlapMuon2:   return !isOverlaping(lvec, *_Muon, CUTS::eRMuon2, stats.dmap.at("Muon2MatchingDeltaR"));
+  case LepCut::OverlapElec1:   return !isOverlaping(lvec, *_Electron, CUTS::eRElec1, stats.dmap.at("Electron1MatchingDeltaR"));
+  case LepCut::OverlapElec2:   return !isOverlaping(lvec, *_Electron, CUTS::eRElec2, stats.dmap.at("Electron2MatchingDeltaR"));
+  default: return true;
+  }
+}
+
+////Jet specific function for finding the number of jets that pass the cuts.
+//used to find the nubmer of good jet1, jet2, central jet, 1st and 2nd leading jets and bjet.
+void Analyzer::getGoodRecoJets(SiblingGroup& group, const int syst) {
+  if(!group.built) buildJetGroup(group);
+
+  size_t nsiblings = group.ePos.size();
+  bool anyActive = false;
+  for(size_t s = 0; s < nsiblings; s++) {
+    CUTS ePos = group.ePos[s];
+    const PartStats& stats = *group.stats[s];
+    group.active[s] = false;
+    group.reuse[s] = false;
+    if(! neededCuts.isPresent(ePos)) continue;
+    if(!systs.at(syst).affects(ePos)) {
+      active_part->at(ePos)=goodParts[ePos];
+      continue;
     }
-    bool passCuts = true;
-    if( ePos == CUTS::eRCenJet) passCuts = passCuts && (fabs(lvec.Eta()) < 2.5);
-    else  passCuts = passCuts && passCutRange(fabs(lvec.Eta()), stats.pmap.at("EtaCut"));
-    passCuts = passCuts && (lvec.Pt() > stats.dmap.at("PtCut")) ;
 
-    for( auto cut: stats.bset) {
-      if(!passCuts) break;
+    NominalSelection& nominal = *group.nominals[s];
+    if(syst == 0) {
+      nominal.clear();
+      nominal.reusable = reuseNominal && !stats.bfind("UseBtagSF");
+    } else group.reuse[s] = nominal.reusable && overlapsUnchanged(stats)
+             && (!group.removeBJets[s] || *active_part->at(CUTS::eRBJet) == *goodParts[CUTS::eRBJet]);
+    group.active[s] = true;
+    anyActive = true;
+  }
+  if(!anyActive) return;
 
-    /// BJet specific
-      else if(cut == "ApplyJetBTagging") passCuts = passCuts && (_Jet->bDiscriminator->at(i) > stats.dmap.at("JetBTaggingCut"));
-      else if(cut == "MatchBToGen") passCuts = passCuts && (isData ||  abs(_Jet->partonFlavour->at(i)) == 5);
-      else if(cut == "ApplyLooseID") passCuts = passCuts && _Jet->passedLooseJetID(i);
+  int i=0;
 
-    // ----anti-overlap requirements
-      else if(cut == "RemoveOverlapWithMuon1s") passCuts = passCuts && !isOverlaping(lvec, *_Muon, CUTS::eRMuon1, stats.dmap.at("Muon1MatchingDeltaR"));
-      else if (cut =="RemoveOverlapWithMuon2s") passCuts = passCuts && !isOverlaping(lvec, *_Muon, CUTS::eRMuon2, stats.dmap.at("Muon2MatchingDeltaR"));
-      else if(cut == "RemoveOverlapWithElectron1s") passCuts = passCuts && !isOverlaping(lvec, *_Electron, CUTS::eRElec1, stats.dmap.at("Electron1MatchingDeltaR"));
-      else if(cut == "RemoveOverlapWithElectron2s") passCuts = passCuts && !isOverlaping(lvec, *_Electron, CUTS::eRElec2, stats.dmap.at("Electron2MatchingDeltaR"));
-      else if(cut == "RemoveOverlapWithTau1s") passCuts = passCuts && !isOverlaping(lvec, *_Tau, CUTS::eRTau1, stats.dmap.at("Tau1MatchingDeltaR"));
-      else if (cut =="RemoveOverlapWithTau2s") passCuts = passCuts && !isOverlaping(lvec, *_Tau, CUTS::eRTau2, stats.dmap.at("Tau2MatchingDeltaR"));
+  for(auto lvec: *_Jet) {
+    group.newObject();
+    for(size_t s = 0; s < nsiblings; s++) {
+      if(!group.active[s]) continue;
+      CUTS ePos = group.ePos[s];
+      const PartStats& stats = *group.stats[s];
+      NominalSelection& nominal = *group.nominals[s];
+      if(group.reuse[s] && nominal.holds(i, lvec)) {
+        if(nominal.pass[i]) active_part->at(ePos)->push_back(i);
+        continue;
+      }
+      bool passCuts = true;
+      if( ePos == CUTS::eRCenJet) passCuts = passCuts && (fabs(lvec.Eta()) < 2.5);
+      else  passCuts = passCuts && passCutRange(fabs(lvec.Eta()), stats.pmap.at("EtaCut"));
+      bool ptTested = passCuts;
+      passCuts = passCuts && (lvec.Pt() > group.ptLow[s]) ;
+
+      const std::vector<int>& cuts = group.codes[s];
+      for(size_t k = 0; k < cuts.size() && passCuts; k++) {
+        passCuts = group.shared(s, k, [&]() {
+            switch(static_cast<JetCut>(cuts[k])) {
+              /// BJet specific
+            case JetCut::BTag:         return _Jet->bDiscriminator->at(i) > stats.dmap.at("JetBTaggingCut");
+            case JetCut::MatchBToGen:  return isData ||  abs(_Jet->partonFlavour->at(i)) == 5;
+            case JetCut::LooseID:      return _Jet->passID(i, IDBit::JetLooseID);
 
-      else if(cut == "UseBtagSF") {
-        double bjet_SF = reader.eval_auto_bounds("central", BTagEntry::FLAV_B, lvec.Eta(), lvec.Pt());
-        passCuts = passCuts && (isData || ((double) rand()/(RAND_MAX)) <  bjet_SF);
+              // ----anti-overlap requirements
+            case JetCut::OverlapMuon1: return !isOverlaping(lvec, *_Muon, CUTS::eRMuon1, stats.dmap.at("Muon1MatchingDeltaR"));
+            case JetCut::OverlapMuon2: return !isOverlaping(lvec, *_Muon, CUTS::eRMuon2, stats.dmap.at("Muon2MatchingDeltaR"));
+            case JetCut::OverlapElec1: return !isOverlaping(lvec, *_Electron, CUTS::eRElec1, stats.dmap.at("Electron1MatchingDeltaR"));
+            case JetCut::OverlapElec2: return !isOverlaping(lvec, *_Electron, CUTS::eRElec2, stats.dmap.at("Electron2MatchingDeltaR"));
+            case JetCut::OverlapTau1:  return !isOverlaping(lvec, *_Tau, CUTS::eRTau1, stats.dmap.at("Tau1MatchingDeltaR"));
+            case JetCut::OverlapTau2:  return !isOverlaping(lvec, *_Tau, CUTS::eRTau2, stats.dmap.at("Tau2MatchingDeltaR"));
+
+            case JetCut::BtagSF: {
+              double bjet_SF = reader.eval_auto_bounds("central", BTagEntry::FLAV_B, lvec.Eta(), lvec.Pt());
+              return isData || group.uniform(s) <  bjet_SF;
+            }
+            }
+            return true;
+          });
       }
+      if(group.removeBJets[s]){
+        passCuts = passCuts && find(active_part->at(CUTS::eRBJet)->begin(), active_part->at(CUTS::eRBJet)->end(), i) == active_part->at(CUTS::eRBJet)->end();
+      }
+      if(passCuts) active_part->at(ePos)->push_back(i);
+      if(syst == 0) nominal.record(lvec, passCuts, ptTested, std::nextafter(group.ptLow[s], HUGE_VAL), HUGE_VAL);
     }
-    if(_Jet->pstats["BJet"].bfind("RemoveBJetsFromJets") and ePos!=CUTS::eRBJet){
-      passCuts = passCuts && find(active_part->at(CUTS::eRBJet)->begin(), active_part->at(CUTS::eRBJet)->end(), i) == active_part->at(CUTS::eRBJet)->end();
-    }
-    if(passCuts) active_part->at(ePos)->push_back(i);
     i++;
-
   }
+}
 
-  //clean up for first and second jet
-  //note the leading jet has to be selected fist!
-  if(ePos == CUTS::eR1stJet || ePos == CUTS::eR2ndJet) {
+////codes and shared slots of the selections of a jet group, read once in the order of the info file
+void Analyzer::buildJetGroup(SiblingGroup& group) {
+  static const std::unordered_map<std::string, JetCut> jetCutNames = {
+    {"ApplyJetBTagging", JetCut::BTag}, {"MatchBToGen", JetCut::MatchBToGen}, {"ApplyLooseID", JetCut::LooseID},
+    {"RemoveOverlapWithMuon1s", JetCut::OverlapMuon1}, {"RemoveOverlapWithMuon2s", JetCut::OverlapMuon2},
+    {"RemoveOverlapWithElectron1s", JetCut::OverlapElec1}, {"RemoveOverlapWithElectron2s", JetCut::OverlapElec2},
+    {"RemoveOverlapWithTau1s", JetCut::OverlapTau1}, {"RemoveOverlapWithTau2s", JetCut::OverlapTau2},
+    {"UseBtagSF", JetCut::BtagSF}
+  };
+
+  size_t nsiblings = group.ePos.size();
+  group.codes.assign(nsiblings, std::vector<int>());
+  group.slots.assign(nsiblings, std::vector<int>());
+  group.active.assign(nsiblings, false);
+  group.reuse.assign(nsiblings, false);
+  group.removeBJets.assign(nsiblings, false);
+  group.random.clear();
+  for(size_t s = 0; s < nsiblings; s++) {
+    CUTS ePos = group.ePos[s];
+    const PartStats& stats = *group.stats[s];
+    group.removeBJets[s] = _Jet->pstats["BJet"].bfind("RemoveBJetsFromJets") && ePos != CUTS::eRBJet;
+    group.random.emplace_back(static_cast<unsigned>(ePos));
+    for(auto cutName: stats.bset) {
+      auto found = jetCutNames.find(cutName);
+      if(found == jetCutNames.end()) continue;
+      JetCut cut = found->second;
+      std::string key = std::to_string(static_cast<int>(cut));
+      switch(cut) {
+      case JetCut::BTag:         key += " " + num(stats.dmap.at("JetBTaggingCut")); break;
+      case JetCut::OverlapMuon1: key += " " + num(stats.dmap.at("Muon1MatchingDeltaR")); break;
+      case JetCut::OverlapMuon2: key += " " + num(stats.dmap.at("Muon2MatchingDeltaR")); break;
+      case JetCut::OverlapElec1: key += " " + num(stats.dmap.at("Electron1MatchingDeltaR")); break;
+      case JetCut::OverlapElec2: key += " " + num(stats.dmap.at("Electron2MatchingDeltaR")); break;
+      case JetCut::OverlapTau1:  key += " " + num(stats.dmap.at("Tau1MatchingDeltaR")); break;
+      case JetCut::OverlapTau2:  key += " " + num(stats.dmap.at("Tau2MatchingDeltaR")); break;
+        ////random draw per selection, never shared
+      case JetCut::BtagSF:       key += " " + std::to_string(static_cast<int>(ePos)); break;
+      default: break;
+      }
+      group.codes[s].push_back(static_cast<int>(cut));
+      group.slots[s].push_back(group.slot(key));
+    }
+    group.etaHigh.push_back(0.);
+    group.ptLow.push_back(stats.dmap.at("PtCut"));
+    group.ptHigh.push_back(HUGE_VAL);
+    group.isoFirst.push_back(0.);
+    group.isoSecond.push_back(0.);
+    group.nominals.push_back(&nominalSelection[ePos]);
+    group.orders.push_back(nullptr);
+  }
+  group.built = true;
+}
 
-    std::vector<std::pair<double, int> > ptIndexVector;
-    for(auto it : *active_part->at(CUTS::eRJet1)) {
-      ptIndexVector.push_back(std::make_pair(_Jet->pt(it),it));
-    }
-    sort(ptIndexVector.begin(),ptIndexVector.end());
-    if(ePos == CUTS::eR1stJet && ptIndexVector.size()>0){
-      active_part->at(ePos)->push_back(ptIndexVector.back().second);
-    }
-    else if(ePos == CUTS::eR2ndJet && ptIndexVector.size()>1){
-      active_part->at(ePos)->push_back(ptIndexVector.at(ptIndexVector.size()-2).second);
-    }
-    
+////leading and second leading jet of Jet1
+//note Jet1 has to be selected fist!
+void Analyzer::getLeadingJet(CUTS ePos, const int syst) {
+  if(! neededCuts.isPresent(ePos)) return;
+
+  if(!systs.at(syst).affects(ePos)) {
+    active_part->at(ePos)=goodParts[ePos];
+    return;
   }
 
+  int index = leading(*_Jet, CUTS::eRJet1, (ePos == CUTS::eR1stJet) ? 0 : 1);
+  if(index >= 0) active_part->at(ePos)->push_back(index);
+}
+
+int Analyzer::leading(const Particle& part, CUTS ePos, size_t k) {
+  const std::vector<int>* list = active_part->at(ePos);
+  if(k >= list->size()) return -1;
+
+  ////the same list object is the same selection, also when a systematic shares the nominal one
+  PtOrder* ptOrder = nullptr;
+  for(size_t i = 0; i < nPtOrders; i++) {
+    if(ptOrders[i].list == list) ptOrder = &ptOrders[i];
+  }
+  if(ptOrder == nullptr) {
+    if(nPtOrders == ptOrders.size()) ptOrders.emplace_back();
+    ptOrder = &ptOrders[nPtOrders++];
+    ptOrder->list = list;
+    ptOrder->order.assign(list->begin(), list->end());
+    ptOrder->sorted = 0;
+  }
+
+  ////highest pt first, equal pt: higher index first (as sorting (pt, index) pairs)
+  std::vector<int>& order = ptOrder->order;
+  if(k >= ptOrder->sorted) {
+    partial_sort(order.begin() + ptOrder->sorted, order.begin() + k + 1, order.end(), [&](int a, int b) {
+        double pta = part.pt(a), ptb = part.pt(b);
+        return pta > ptb || (pta == ptb && a > b);
+      });
+    ptOrder->sorted = k + 1;
+  }
+  return order[k];
 }
 
 
@@ -1455,16 +1951,29 @@ void Analyzer::getGoodRecoFatJets(CUTS ePos, const PartStats& stats, const int s
   if(! neededCuts.isPresent(ePos)) return;
 
   std::string systname = syst_names.at(syst);
-  if(!_FatJet->needSyst(syst)) {
+  if(!systs.at(syst).affects(ePos)) {
     active_part->at(ePos)=goodParts[ePos];
     return;
   }
 
+  NominalSelection& nominal = nominalSelection[ePos];
+  bool reuse = false;
+  if(syst == 0) {
+    nominal.clear();
+    nominal.reusable = reuseNominal;
+  } else reuse = nominal.reusable && overlapsUnchanged(stats);
+
   int i=0;
 
   for(auto lvec: *_FatJet) {
+    if(reuse && nominal.holds(i, lvec)) {
+      if(nominal.pass[i]) active_part->at(ePos)->push_back(i);
+      i++;
+      continue;
+    }
     bool passCuts = true;
     passCuts = passCuts && passCutRange(fabs(lvec.Eta()), stats.pmap.at("EtaCut"));
+    bool ptTested = passCuts;
     passCuts = passCuts && (lvec.Pt() > stats.dmap.at("PtCut")) ;
 
     ///if else loop for central jet requirements
@@ -1483,17 +1992,61 @@ void Analyzer::getGoodRecoFatJets(CUTS ePos, const PartStats& stats, const int s
 
     }
     if(passCuts) active_part->at(ePos)->push_back(i);
+    if(syst == 0) nominal.record(lvec, passCuts, ptTested, std::nextafter(stats.dmap.at("PtCut"), HUGE_VAL), HUGE_VAL);
     i++;
   }
 }
 
 ///function to see if a lepton is overlapping with another particle.  Used to tell if jet or tau
 //came ro decayed into those leptons
+////eta and phi of the listed particles, for the kin:: array functions
+void Analyzer::fillEtaPhi(Particle& part, const std::vector<int>& list, std::vector<double>& eta, std::vector<double>& phi) {
+  eta.resize(list.size());
+  phi.resize(list.size());
+  for(size_t i = 0; i < list.size(); i++) {
+    const TLorentzVector& lvec = part.p4(list[i]);
+    eta[i] = lvec.Eta();
+    phi[i] = lvec.Phi();
+  }
+}
+
 bool Analyzer::isOverlaping(const TLorentzVector& lvec, Lepton& overlapper, CUTS ePos, double MatchingDeltaR) {
-  for(auto it : *active_part->at(ePos)) {
-    if(lvec.DeltaR(overlapper.p4(it)) < MatchingDeltaR) return true;
+  const std::vector<int>& overlaps = *active_part->at(ePos);
+  if(overlaps.empty()) return false;
+  fillEtaPhi(overlapper, overlaps, overlapEta, overlapPhi);
+  return kin::withinDeltaR(overlaps.size(), overlapEta.data(), overlapPhi.data(), lvec.Eta(), lvec.Phi(), MatchingDeltaR);
+}
+
+////overlap removal gives the nominal answer if the objects it removes against are the nominal ones
+bool Analyzer::overlapsUnchanged(const PartStats& stats) {
+  for(auto& overlap: overlapNames) {
+    if(stats.bfind(overlap.first) && *active_part->at(overlap.second) != *goodParts[overlap.second]) return false;
   }
-  return false;
+  return true;
+}
+
+////same objects as in the nominal pass, pointing the same way
+bool Analyzer::pairInputsUnchanged(const Particle& part1, const Particle& part2, CUTS ePos1, CUTS ePos2) {
+  if(*active_part->at(ePos1) != *goodParts[ePos1] || *active_part->at(ePos2) != *goodParts[ePos2]) return false;
+  const NominalSelection& nominal1 = nominalSelection[ePos1];
+  const NominalSelection& nominal2 = nominalSelection[ePos2];
+  for(auto i1 : *active_part->at(ePos1)) {
+    if(!nominal1.sameDirection(i1, part1.p4(i1))) return false;
+  }
+  for(auto i2 : *active_part->at(ePos2)) {
+    if(!nominal2.sameDirection(i2, part2.p4(i2))) return false;
+  }
+  return true;
+}
+
+////pair cuts that only use the directions and charges, they don't change when the objects are rescaled
+bool Analyzer::pairCutsInvariant(const PartStats& stats) {
+  static const std::vector<std::string> invariant = {"DiscrByDeltaR", "DiscrByCosDphi", "DiscrByDeltaEta", "DiscrByDeltaPhi", "DiscrByOSEta", "DiscrByOSLSType"};
+  if(!reuseNominal) return false;
+  for(auto cut: stats.bset) {
+    if(find(invariant.begin(), invariant.end(), cut) == invariant.end()) return false;
+  }
+  return true;
 }
 
 ///Tests if tau decays into the specified number of jet prongs.
@@ -1515,25 +2068,12 @@ bool Analyzer::isInTheCracks(float etaValue){
 
 
 ///sees if the event passed one of the two cuts provided
-void Analyzer::TriggerCuts(std::vector<int>& prevTrig, const std::vector<std::string>& trigvec, CUTS ePos) {
+void Analyzer::TriggerCuts(const std::vector<uint64_t>& mask, CUTS ePos) {
   if(! neededCuts.isPresent(ePos)) return;
-  //cout<<" trigger "<<Trigger_decision->size()<<std::endl;
-  if(version==1){
-    for(size_t i = 0; i < trigvec.size(); i++) {
-      for(size_t j =0; j<Trigger_decisionV1->size();  j++){
-        //cout<<"i:  "<<prevTrig.at(i)<<" j:  "<<j<<" dec(j):  "<<Trigger_decisionV1->at(j)<<std::endl;
-        if(prevTrig.at(i)==Trigger_decisionV1->at(j)){
-          active_part->at(ePos)->push_back(0);
-          return;
-        }
-      }
-    }
-  }else{
-    for(int i = 0; i < (int)trigvec.size(); i++) {
-      if(Trigger_decision->at(prevTrig.at(i)) == 1) {
-        active_part->at(ePos)->push_back(0);
-        return;
-      }
+  for(size_t i = 0; i < mask.size(); i++) {
+    if(mask[i] & firedTriggers[i]) {
+      active_part->at(ePos)->push_back(0);
+      return;
     }
   }
 }
@@ -1542,16 +2082,11 @@ void Analyzer::TriggerCuts(std::vector<int>& prevTrig, const std::vector<std::st
 ////VBF specific cuts dealing with the leading jets.
 void Analyzer::VBFTopologyCut(const PartStats& stats, const int syst) {
   if(! neededCuts.isPresent(CUTS::eSusyCom)) return;
-  std::string systname = syst_names.at(syst);
-
-
-  if(systname!="orig"){
+  if(!systs.at(syst).affects(CUTS::eSusyCom)){
     //only jet stuff is affected
     //save time to not rerun stuff
-    if( systname.find("Jet")==std::string::npos){
-      active_part->at(CUTS::eSusyCom)=goodParts[CUTS::eSusyCom];
-      return;
-    }
+    active_part->at(CUTS::eSusyCom)=goodParts[CUTS::eSusyCom];
+    return;
   }
 
   if(active_part->at(CUTS::eR1stJet)->size()==0 || active_part->at(CUTS::eR2ndJet)->size()==0) return;
@@ -1562,41 +2097,54 @@ void Analyzer::VBFTopologyCut(const PartStats& stats, const int syst) {
   double dphi1 = normPhi(ljet1.Phi() - _MET->phi());
   double dphi2 = normPhi(ljet2.Phi() - _MET->phi());
 
-  bool passCuts = true;
-  for(auto cut: stats.bset) {
-    if(!passCuts) break;
-    else if(cut == "DiscrByMass") passCuts = passCuts && passCutRange(dijet.M(), stats.pmap.at("MassCut"));
-    else if(cut == "DiscrByPt") passCuts = passCuts && passCutRange(dijet.Pt(), stats.pmap.at("PtCut"));
-    else if(cut == "DiscrByDeltaEta") passCuts = passCuts && passCutRange(abs(ljet1.Eta() - ljet2.Eta()), stats.pmap.at("DeltaEtaCut"));
-    else if(cut == "DiscrByDeltaPhi") passCuts = passCuts && passCutRange(absnormPhi(ljet1.Phi() - ljet2.Phi()), stats.pmap.at("DeltaPhiCut"));
-    else if(cut == "DiscrByOSEta") passCuts = passCuts && (ljet1.Eta() * ljet2.Eta() < 0);
-    else if(cut == "DiscrByR1") passCuts = passCuts && passCutRange(sqrt( pow(dphi1,2.0) + pow((TMath::Pi() - dphi2),2.0)), stats.pmap.at("R1Cut"));
-    else if(cut == "DiscrByR2") passCuts = passCuts && passCutRange(sqrt( pow(dphi2,2.0) + pow((TMath::Pi() - dphi1),2.0)), stats.pmap.at("R2Cut"));
-    else if(cut == "DiscrByAlpha") {
-      double alpha = (dijet.M() > 0) ? ljet2.Pt() / dijet.M() : -1;
-      passCuts = passCuts && passCutRange(alpha, stats.pmap.at("AlphaCut"));
-    }
-    else if(cut == "DiscrByDphi1") passCuts = passCuts && passCutRange(abs(dphi1), stats.pmap.at("Dphi1Cut"));
-    else if(cut == "DiscrByDphi2") passCuts = passCuts && passCutRange(abs(dphi2), stats.pmap.at("Dphi2Cut"));
+  CutOrder& order = cutOrders[CUTS::eSusyCom];
+  if(!order.isSet()) order.setCuts(cutName(CUTS::eSusyCom), stats.bset, cutOrderWarmup, pinnedCutOrder(stats));
+
+  bool passCuts = order.pass([&](int k) {
+      const std::string& cut = order.name(k);
+      if(cut == "DiscrByMass") return passCutRange(dijet.M(), stats.pmap.at("MassCut"));
+      else if(cut == "DiscrByPt") return passCutRange(dijet.Pt(), stats.pmap.at("PtCut"));
+      else if(cut == "DiscrByDeltaEta") return passCutRange(abs(ljet1.Eta() - ljet2.Eta()), stats.pmap.at("DeltaEtaCut"));
+      else if(cut == "DiscrByDeltaPhi") return passCutRange(absnormPhi(ljet1.Phi() - ljet2.Phi()), stats.pmap.at("DeltaPhiCut"));
+      else if(cut == "DiscrByOSEta") return (ljet1.Eta() * ljet2.Eta() < 0);
+      else if(cut == "DiscrByR1") return passCutRange(sqrt( pow(dphi1,2.0) + pow((TMath::Pi() - dphi2),2.0)), stats.pmap.at("R1Cut"));
+      else if(cut == "DiscrByR2") return passCutRange(sqrt( pow(dphi2,2.0) + pow((TMath::Pi() - dphi1),2.0)), stats.pmap.at("R2Cut"));
+      else if(cut == "DiscrByAlpha") {
+        double alpha = (dijet.M() > 0) ? ljet2.Pt() / dijet.M() : -1;
+        return passCutRange(alpha, stats.pmap.at("AlphaCut"));
+      }
+      else if(cut == "DiscrByDphi1") return passCutRange(abs(dphi1), stats.pmap.at("Dphi1Cut"));
+      else if(cut == "DiscrByDphi2") return passCutRange(abs(dphi2), stats.pmap.at("Dphi2Cut"));
 
-    else std::cout << "cut: " << cut << " not listed" << std::endl;
-  }
+      std::cout << "cut: " << cut << " not listed" << std::endl;
+      return true;
+    });
 
   if(passCuts)  active_part->at(CUTS::eSusyCom)->push_back(0);
   return;
 }
 
+////name of a selection in Cuts.in (NRecoTau1, NDiTauCombinations, ...)
+////CutOrder of a selection group, "" if its cut order isn't pinned
+std::string Analyzer::pinnedCutOrder(const PartStats& stats) {
+  auto found = stats.smap.find("CutOrder");
+  return (found != stats.smap.end()) ? found->second : "";
+}
+
+std::string Analyzer::cutName(CUTS ePos) {
+  for(auto& cut: cut_num) {
+    if(cut.second == ePos) return cut.first;
+  }
+  return std::to_string(static_cast<int>(ePos));
+}
+
 bool Analyzer::passCutRange(double value, const std::pair<double, double>& cuts) {
   return (value > cuts.first && value < cuts.second);
 }
 
 //-----Calculate lepton+met transverse mass
 double Analyzer::calculateLeptonMetMt(const TLorentzVector& Tobj) {
-  double px = Tobj.Px() + _MET->px();
-  double py = Tobj.Py() + _MET->py();
-  double et = Tobj.Et() + _MET->energy();
-  double mt2 = et*et - (px*px + py*py);
-  return (mt2 >= 0) ? sqrt(mt2) : -1;
+  return kin::transverseMass(Tobj.Px(), Tobj.Py(), Tobj.Et(), _MET->px(), _MET->py(), _MET->energy());
 }
 
 
@@ -1605,36 +2153,35 @@ double Analyzer::calculateLeptonMetMt(const TLorentzVector& Tobj) {
 ///can use VectorSumOfVisProductAndMet which is sum of particles and met
 ///Other which is adding without met
 double Analyzer::diParticleMass(const TLorentzVector& Tobj1, const TLorentzVector& Tobj2, std::string howCalc) {
-  bool ratioNotInRange = false;
-  TLorentzVector The_LorentzVect;
-
-  if(howCalc == "InvariantMass") {
-    return (Tobj1 + Tobj2).M();
-  }
-
+  return diParticleMass(Tobj1, Tobj2, kin::massMethod(howCalc));
+}
 
+double Analyzer::diParticleMass(const TLorentzVector& Tobj1, const TLorentzVector& Tobj2, kin::MassMethod method) {
   //////check this equation/////
-  if(howCalc == "CollinearApprox") {
-    double denominator = (Tobj1.Px() * Tobj2.Py()) - (Tobj2.Px() * Tobj1.Py());
-    double x1 = (Tobj2.Py()*_MET->px() - Tobj2.Px()*_MET->py())/denominator;
-    double x2 = (Tobj1.Px()*_MET->py() - Tobj1.Py()*_MET->px())/denominator;
-    ratioNotInRange=!((x1 < 0.) && (x2 < 0.));
-    if (!ratioNotInRange) {
-      The_LorentzVect.SetPxPyPzE( (Tobj1.Px()*(1 + x1) + Tobj2.Px()*(1+x2)), (Tobj1.Py()*(1+x1) + Tobj2.Py()*(1+x2)), (Tobj1.Pz()*(1+x1) + Tobj2.Pz()*(1+x2)), (Tobj1.Energy()*(1+x1) + Tobj2.Energy()*(1+x2)) );
-      return The_LorentzVect.M();
+  if(method == kin::MassMethod::Collinear) {
+    double x1, x2;
+    if(kin::collinearFractions(Tobj1.Px(), Tobj1.Py(), Tobj2.Px(), Tobj2.Py(), _MET->px(), _MET->py(), x1, x2)) {
+      return kin::mass(Tobj1.Energy()*(1+x1) + Tobj2.Energy()*(1+x2), Tobj1.Px()*(1+x1) + Tobj2.Px()*(1+x2),
+                       Tobj1.Py()*(1+x1) + Tobj2.Py()*(1+x2), Tobj1.Pz()*(1+x1) + Tobj2.Pz()*(1+x2));
     }
   }
 
-  if(howCalc == "VectorSumOfVisProductsAndMet" || ratioNotInRange) {
-    return (Tobj1 + Tobj2 + _MET->p4()).M();
+  if(method == kin::MassMethod::VectorSumWithMet || method == kin::MassMethod::Collinear) {
+    const TLorentzVector& met = _MET->p4();
+    return kin::mass(Tobj1.E() + Tobj2.E() + met.E(), Tobj1.Px() + Tobj2.Px() + met.Px(),
+                     Tobj1.Py() + Tobj2.Py() + met.Py(), Tobj1.Pz() + Tobj2.Pz() + met.Pz());
   }
 
-  return (Tobj1 + Tobj2).M();
+  return kin::mass(Tobj1.E() + Tobj2.E(), Tobj1.Px() + Tobj2.Px(), Tobj1.Py() + Tobj2.Py(), Tobj1.Pz() + Tobj2.Pz());
 }
 
 ////Tests if the CollinearApproximation works for finding the mass of teh particles
 bool Analyzer::passDiParticleApprox(const TLorentzVector& Tobj1, const TLorentzVector& Tobj2, std::string howCalc) {
-  if(howCalc == "CollinearApprox") {
+  return passDiParticleApprox(Tobj1, Tobj2, kin::massMethod(howCalc));
+}
+
+bool Analyzer::passDiParticleApprox(const TLorentzVector& Tobj1, const TLorentzVector& Tobj2, kin::MassMethod method) {
+  if(method == kin::MassMethod::Collinear) {
     double x1_numerator = (Tobj1.Px() * Tobj2.Py()) - (Tobj2.Px() * Tobj1.Py());
     double x1_denominator = (Tobj2.Py() * (Tobj1.Px() + _MET->px())) - (Tobj2.Px() * (Tobj1.Py() + _MET->py()));
     double x1 = ( x1_denominator != 0. ) ? x1_numerator/x1_denominator : -1.;
@@ -1650,59 +2197,94 @@ bool Analyzer::passDiParticleApprox(const TLorentzVector& Tobj1, const TLorentzV
 
 /////abs for values
 ///Find the number of lepton combos that pass the dilepton cuts
-void Analyzer::getGoodLeptonCombos(Lepton& lep1, Lepton& lep2, CUTS ePos1, CUTS ePos2, CUTS ePosFin, const PartStats& stats, const int syst) {
+template <class T1, class T2>
+void Analyzer::getGoodLeptonCombos(T1& lep1, T2& lep2, CUTS ePos1, CUTS ePos2, CUTS ePosFin, const PartStats& stats, const int syst) {
   if(! neededCuts.isPresent(ePosFin)) return;
   std::string systname = syst_names.at(syst);
 
-  if(!lep1.needSyst(syst) && !lep2.needSyst(syst)) {
+  if(!systs.at(syst).affects(ePosFin)) {
     active_part->at(ePosFin)=goodParts[ePosFin];
     return;
   }
+  if(syst == 0) nominalPairReusable[ePosFin] = pairCutsInvariant(stats);
+  else if(nominalPairReusable[ePosFin] && pairInputsUnchanged(lep1, lep2, ePos1, ePos2)) {
+    *active_part->at(ePosFin) = *goodParts[ePosFin];
+    return;
+  }
 
-  bool sameParticle = (&lep1 == &lep2);
+  bool sameParticle = (static_cast<const void*>(&lep1) == static_cast<const void*>(&lep2));
   TLorentzVector part1, part2;
 
-  for(auto i1 : *active_part->at(ePos1)) {
+  ////charge requirement: DiscrByOSLSType true (same sign), a number (not same sign) or OS/LS
+  enum class OSLS {None, Same, NotSame, Opposite};
+  OSLS chargeRequirement = OSLS::None;
+  if(stats.bfind("DiscrByOSLSType")) chargeRequirement = OSLS::Same;
+  else if(stats.dmap.find("DiscrByOSLSType") != stats.dmap.end()) chargeRequirement = OSLS::NotSame;
+  else if(stats.smap.find("DiscrByOSLSType") != stats.smap.end()) {
+    if(stats.smap.at("DiscrByOSLSType") == "LS") chargeRequirement = OSLS::Same;
+    else if(stats.smap.at("DiscrByOSLSType") == "OS") chargeRequirement = OSLS::Opposite;
+  }
+  CutOrder& order = cutOrders[ePosFin];
+  if(!order.isSet()) {
+    std::vector<std::string> names;
+    for(auto& cut: stats.bset) {
+      if(cut != "DiscrByOSLSType") names.push_back(cut);
+    }
+    if(chargeRequirement != OSLS::None) names.push_back("DiscrByOSLSType");
+    order.setCuts(cutName(ePosFin), names, cutOrderWarmup, pinnedCutOrder(stats));
+  }
+  kin::MassMethod massMethod = (stats.bfind("DiscrByMassReco")) ? kin::massMethod(stats.smap.at("HowCalculateMassReco")) : kin::MassMethod::Visible;
+
+  ////all Delta R of the combinations at once
+  const std::vector<int>& list1 = *active_part->at(ePos1);
+  const std::vector<int>& list2 = *active_part->at(ePos2);
+  bool cutDeltaR = stats.bfind("DiscrByDeltaR");
+  double deltaRCut2 = 0;
+  if(cutDeltaR) {
+    deltaRCut2 = stats.dmap.at("DeltaRCut") * stats.dmap.at("DeltaRCut");
+    fillEtaPhi(lep1, list1, pairEta1, pairPhi1);
+    fillEtaPhi(lep2, list2, pairEta2, pairPhi2);
+    pairDeltaR2.resize(list1.size() * list2.size());
+    kin::deltaR2(list1.size(), pairEta1.data(), pairPhi1.data(), list2.size(), pairEta2.data(), pairPhi2.data(), pairDeltaR2.data());
+  }
+
+  for(size_t j1 = 0; j1 < list1.size(); j1++) {
+    int i1 = list1[j1];
     part1 = lep1.p4(i1);
-    for(auto i2 : *active_part->at(ePos2)) {
+    for(size_t j2 = 0; j2 < list2.size(); j2++) {
+      int i2 = list2[j2];
       if(sameParticle && i2 <= i1) continue;
       part2 = lep2.p4(i2);
-      bool passCuts = true;
-      for(auto cut : stats.bset) {
-        if(!passCuts) break;
-        else if (cut == "DiscrByDeltaR") passCuts = passCuts && (part1.DeltaR(part2) >= stats.dmap.at("DeltaRCut"));
-        else if(cut == "DiscrByCosDphi") passCuts = passCuts && passCutRange(cos(absnormPhi(part1.Phi() - part2.Phi())), stats.pmap.at("CosDphiCut"));
-        else if(cut == "DiscrByDeltaPt") passCuts = passCuts && passCutRange(part1.Pt() - part2.Pt(), stats.pmap.at("DeltaPtCutValue"));
-        else if(cut == "DiscrByCDFzeta2D") {
-          double CDFzeta = stats.dmap.at("PZetaCutCoefficient") * getPZeta(part1, part2).first
-            + stats.dmap.at("PZetaVisCutCoefficient") * getPZeta(part1, part2).second;
-          passCuts = passCuts && passCutRange(CDFzeta, stats.pmap.at("CDFzeta2DCutValue"));
-        }
-        else if(cut == "DiscrByDeltaPtDivSumPt") {
-          double ptDiv = (part1.Pt() - part2.Pt()) / (part1.Pt() + part2.Pt());
-          passCuts = passCuts && passCutRange(ptDiv, stats.pmap.at("DeltaPtDivSumPtCutValue"));
-        }
-        else if (cut == "DiscrByMassReco") {
-          double diMass = diParticleMass(part1,part2, stats.smap.at("HowCalculateMassReco"));
-          passCuts = passCuts && passCutRange(diMass, stats.pmap.at("MassCut"));
-        }
-        else if(cut == "DiscrByCosDphiPtAndMet"){
-          double CosDPhi1 = cos(absnormPhi(part1.Phi() - _MET->phi()));
-          passCuts = passCuts && passCutRange(CosDPhi1, stats.pmap.at("CosDphiPtAndMetCut"));
-        }
-
-
-        else std::cout << "cut: " << cut << " not listed" << std::endl;
-      }
-      if (stats.bfind("DiscrByOSLSType")){
-        //   if it is 1 or 0 it will end up in the bool std::map!!
-        if(stats.bfind("DiscrByOSLSType") && (lep1.charge(i1) * lep2.charge(i2) <= 0)) continue;
-      }else if (stats.dmap.find("DiscrByOSLSType") != stats.dmap.end() ){
-        if(lep1.charge(i1) * lep2.charge(i2) > 0) continue;
-      }else if (stats.smap.find("DiscrByOSLSType") != stats.smap.end() ){
-        if(stats.smap.at("DiscrByOSLSType") == "LS" && (lep1.charge(i1) * lep2.charge(i2) <= 0)) continue;
-        else if(stats.smap.at("DiscrByOSLSType") == "OS" && (lep1.charge(i1) * lep2.charge(i2) >= 0)) continue;
-      }
+      bool passCuts = order.pass([&](int k) {
+          const std::string& cut = order.name(k);
+          if(cut == "DiscrByOSLSType") {
+            double sign = lep1.T1::charge(i1) * lep2.T2::charge(i2);
+            return (chargeRequirement == OSLS::Same) ? sign > 0 : (chargeRequirement == OSLS::NotSame) ? sign <= 0 : sign < 0;
+          }
+          else if (cut == "DiscrByDeltaR") return pairDeltaR2[j1*list2.size() + j2] >= deltaRCut2;
+          else if(cut == "DiscrByCosDphi") return passCutRange(cos(absnormPhi(part1.Phi() - part2.Phi())), stats.pmap.at("CosDphiCut"));
+          else if(cut == "DiscrByDeltaPt") return passCutRange(part1.Pt() - part2.Pt(), stats.pmap.at("DeltaPtCutValue"));
+          else if(cut == "DiscrByCDFzeta2D") {
+            std::pair<double, double> pzeta = getPZeta(part1, part2);
+            double CDFzeta = stats.dmap.at("PZetaCutCoefficient") * pzeta.first
+              + stats.dmap.at("PZetaVisCutCoefficient") * pzeta.second;
+            return passCutRange(CDFzeta, stats.pmap.at("CDFzeta2DCutValue"));
+          }
+          else if(cut == "DiscrByDeltaPtDivSumPt") {
+            double ptDiv = (part1.Pt() - part2.Pt()) / (part1.Pt() + part2.Pt());
+            return passCutRange(ptDiv, stats.pmap.at("DeltaPtDivSumPtCutValue"));
+          }
+          else if (cut == "DiscrByMassReco") {
+            double diMass = diParticleMass(part1,part2, massMethod);
+            return passCutRange(diMass, stats.pmap.at("MassCut"));
+          }
+          else if(cut == "DiscrByCosDphiPtAndMet"){
+            double CosDPhi1 = cos(absnormPhi(part1.Phi() - _MET->phi()));
+            return passCutRange(CosDPhi1, stats.pmap.at("CosDphiPtAndMetCut"));
+          }
+          std::cout << "cut: " << cut << " not listed" << std::endl;
+          return true;
+        });
 
       ///Particles that lead to good combo are nGen * part1 + part2
       /// final / nGen = part1 (make sure is integer)
@@ -1718,10 +2300,15 @@ void Analyzer::getGoodLeptonCombos(Lepton& lep1, Lepton& lep2, CUTS ePos1, CUTS
 void Analyzer::getGoodLeptonJetCombos(Lepton& lep1, Jet& jet1, CUTS ePos1, CUTS ePos2, CUTS ePosFin, const PartStats& stats, const int syst) {
   if(! neededCuts.isPresent(ePosFin)) return;
   std::string systname = syst_names.at(syst);
-  if(!lep1.needSyst(syst) && !jet1.needSyst(syst)) {
+  if(!systs.at(syst).affects(ePosFin)) {
     active_part->at(ePosFin)=goodParts[ePosFin];
     return;
   }
+  if(syst == 0) nominalPairReusable[ePosFin] = pairCutsInvariant(stats);
+  else if(nominalPairReusable[ePosFin] && pairInputsUnchanged(lep1, jet1, ePos1, ePos2)) {
+    *active_part->at(ePosFin) = *goodParts[ePosFin];
+    return;
+  }
 
   TLorentzVector llep1, ljet1;
   // ----Separation cut between jets (remove overlaps)
@@ -1756,13 +2343,15 @@ void Analyzer::getGoodLeptonJetCombos(Lepton& lep1, Jet& jet1, CUTS ePos1, CUTS
 /////Same as gooddilepton, just jet specific
 void Analyzer::getGoodDiJets(const PartStats& stats, const int syst) {
   if(! neededCuts.isPresent(CUTS::eDiJet)) return;
-  std::string systname = syst_names.at(syst);
-  if(systname!="orig"){
+  if(!systs.at(syst).affects(CUTS::eDiJet)){
     //save time to not rerun stuff
-    if( systname.find("Jet")==std::string::npos){
-      active_part->at(CUTS::eDiJet)=goodParts[CUTS::eDiJet];
-      return;
-    }
+    active_part->at(CUTS::eDiJet)=goodParts[CUTS::eDiJet];
+    return;
+  }
+  if(syst == 0) nominalPairReusable[CUTS::eDiJet] = pairCutsInvariant(stats);
+  else if(nominalPairReusable[CUTS::eDiJet] && pairInputsUnchanged(*_Jet, *_Jet, CUTS::eRJet1, CUTS::eRJet2)) {
+    *active_part->at(CUTS::eDiJet) = *goodParts[CUTS::eDiJet];
+    return;
   }
   TLorentzVector jet1, jet2;
   // ----Separation cut between jets (remove overlaps)
@@ -1821,15 +2410,9 @@ bool Analyzer::isZdecay(const TLorentzVector& theObject, const Lepton& lep) {
 
 ///Calculates the Pzeta value
 std::pair<double, double> Analyzer::getPZeta(const TLorentzVector& Tobj1, const TLorentzVector& Tobj2) {
-  double zetaX = cos(Tobj1.Phi()) + cos(Tobj2.Phi());
-  double zetaY = sin(Tobj1.Phi()) + sin(Tobj2.Phi());
-  double zetaR = TMath::Sqrt(zetaX*zetaX + zetaY*zetaY);
-  if ( zetaR > 0. ) { zetaX /= zetaR; zetaY /= zetaR; }
-  double visPx = Tobj1.Px() + Tobj2.Px();
-  double visPy = Tobj1.Py() + Tobj2.Py();
-  double px = visPx + _MET->px();
-  double py = visPy + _MET->py();
-  return std::make_pair(px*zetaX + py*zetaY, visPx*zetaX + visPy*zetaY);
+  double pzeta, pzetaVis;
+  kin::pZeta(Tobj1.Px(), Tobj1.Py(), Tobj1.Phi(), Tobj2.Px(), Tobj2.Py(), Tobj2.Phi(), _MET->px(), _MET->py(), pzeta, pzetaVis);
+  return std::make_pair(pzeta, pzetaVis);
 }
 
 double Analyzer::getZBoostWeight(){
@@ -1843,15 +2426,7 @@ double Analyzer::getZBoostWeight(){
     if(active_part->at(CUTS::eGW)->size() ==1){
       boostz = _Gen->pt(active_part->at(CUTS::eGW)->at(0));
     }
-    if(boostz > 0 && boostz <= 50) {boostweigth = 1.1192;}
-    else if (boostz > 50 && boostz <= 100) {boostweigth = 1.1034;}
-    else if (boostz > 100 && boostz <= 150) {boostweigth = 1.0675;}
-    else if (boostz > 150 && boostz <= 200) {boostweigth = 1.0637;}
-    else if (boostz > 200 && boostz <= 300) {boostweigth = 1.0242;}
-    else if (boostz > 300 && boostz <= 400) {boostweigth = 0.9453;}
-    else if (boostz > 400 && boostz <= 600) {boostweigth = 0.8579;}
-    else if (boostz >= 600) {boostweigth = 0.7822;}
-    else {boostweigth = 1;}
+    boostweigth = zBoostTable.at(boostz);
   }
   return boostweigth;
 }
@@ -1868,13 +2443,13 @@ double Analyzer::getWkfactor(){
       return 1.;
     }
     if(active_part->at(CUTS::eGTau)->size()){
-      kfactor=k_ele_h->GetBinContent(k_ele_h->FindBin(wmass));
+      kfactor=kFactorEle.at(wmass);
     }
     else if(active_part->at(CUTS::eGMuon)->size()){
-      kfactor=k_mu_h->GetBinContent(k_mu_h->FindBin(wmass));
+      kfactor=kFactorMu.at(wmass);
     }
     else if(active_part->at(CUTS::eGElec)->size()){
-      kfactor=k_tau_h->GetBinContent(k_tau_h->FindBin(wmass));
+      kfactor=kFactorTau.at(wmass);
     }
   }
   return kfactor;
@@ -1883,68 +2458,48 @@ double Analyzer::getWkfactor(){
 
 ////Grabs a list of the groups of histograms to be filled and asked Fill_folder to fill up the histograms
 void Analyzer::fill_histogram() {
-  if(distats["Run"].bfind("ApplyGenWeight") && gen_weight == 0.0) return;
+  if(applyGenWeight && gen_weight == 0.0) return;
 
   if(isData && blinded && maxCut == SignalRegion) return;
 
   const std::vector<std::string>* groups = histo.get_groups();
-  if(!isData){
-    wgt = 1.;
-    if(distats["Run"].bfind("UsePileUpWeight")) wgt*= pu_weight;
-    if(distats["Run"].bfind("ApplyGenWeight")) wgt *= (gen_weight > 0) ? 1.0 : -1.0;
-    //add weight here
-    if(distats["Run"].bfind("ApplyTauIDSF")) wgt *= getTauDataMCScaleFactor(0);
-
-    if(distats["Run"].bfind("ApplyZBoostSF") && isVSample){
-      wgt *= getZBoostWeight();
-    }
-    if(distats["Run"].bfind("ApplyWKfactor")){
-      wgt *= getWkfactor();
-    }
-  }else  wgt=1.;
+  ////all the weights and their variations, the providers are chosen in setupEventWeights
+  eventWeights.evaluate();
+  wgt = eventWeights.nominal();
   //backup current weight
   backup_wgt=wgt;
 
+  if(cutScanOnly) {
+    if(fillCuts(true)) scanner->fill(wgt);
+    return;
+  }
+
   for(size_t i = 0; i < syst_names.size(); i++) {
+    if(systs.at(i).isWeight()) continue;
     for(Particle* ipart: allParticles) ipart->setCurrentP(i);
     _MET->setCurrentP(i);
     active_part =&syst_parts.at(i);
     //////i == 0 is orig or no syst case
     if(i == 0) {
       active_part = &goodParts;
-      fillCuts(true);
+      if(usePdfWeights) histo.setMultiWeights(pdf_weights);
+      if(bootstrap != nullptr) {
+        bootstrap->generate((uint64_t)bootstrapLeaf->GetValue());
+        histo.setMultiWeights(&bootstrap->weights());
+      }
+      bool passAll = fillCuts(true);
+      if(bootstrap != nullptr && crbins == 1) bootstrap->fillCutFlow(cutMask, maxCut);
       for(auto it: *groups) {
         fill_Folder(it, maxCut, histo, false);
       }
+      if(doNMinusOne) fill_NMinusOne();
+      if(cutMaskOut != nullptr) writeCutMask();
+      if(passAll && weightSysts.size() != 0) fill_WeightSysts();
       if(!fillCuts(false)) {
         fill_Tree();
       }
     }else{
       wgt=backup_wgt;
-      if(syst_names[i].find("weight")!=std::string::npos){
-        if(syst_names[i]=="Tau_weight_Up"){
-          if(distats["Run"].bfind("ApplyTauIDSF")) {
-            wgt/=getTauDataMCScaleFactor(0);
-            wgt *= getTauDataMCScaleFactor(1);
-          }
-        }else if(syst_names[i]=="Tau_weight_Down"){
-          if(distats["Run"].bfind("ApplyTauIDSF")) {
-            wgt/=getTauDataMCScaleFactor(0);
-            wgt *= getTauDataMCScaleFactor(-1);
-          }
-        }
-        if(syst_names[i]=="Pileup_weight_Up"){
-          if(distats["Run"].bfind("UsePileUpWeight")) {
-            wgt/=   pu_weight;
-            wgt *=  hPU_up[(int)(nTruePU+1)];
-          }
-        }else if(syst_names[i]=="Pileup_weight_Down"){
-          if(distats["Run"].bfind("UsePileUpWeight")) {
-            wgt/=   pu_weight;
-            wgt *=  hPU_down[(int)(nTruePU+1)];
-          }
-        }
-      }
       //get the non particle conditions:
       for(auto itCut : nonParticleCuts){
         active_part->at(itCut)=goodParts.at(itCut);
@@ -1961,6 +2516,153 @@ void Analyzer::fill_histogram() {
   active_part = &goodParts;
 }
 
+////the weight systematics share the nominal selection: fill all of them at once as weight columns
+////with the full weight of each variation (wgt is 1 meanwhile)
+void Analyzer::fill_WeightSysts() {
+  for(size_t i = 0; i < weightSysts.size(); i++) {
+    weightScales[i] = eventWeights.variant(weightVariants[i]);
+  }
+  wgt = 1.;
+  syst_histo.beginWeightColumns(weightScales);
+  for(auto it: *syst_histo.get_groups()) {
+    fill_Folder(it, 0, syst_histo, true);
+  }
+  syst_histo.endWeightColumns();
+  wgt = backup_wgt;
+}
+
+////picks the event weights once, in the order they used to be multiplied
+void Analyzer::setupEventWeights() {
+  applyGenWeight = distats["Run"].bfind("ApplyGenWeight");
+  if(isData) return;
+  eventWeights.setMonitor(distats["Run"].bfind("MonitorWeights"));
+
+  if(distats["Run"].bfind("UsePileUpWeight")) {
+    eventWeights.addProvider("Pileup", [this](double& nominal, double& up, double& down) {
+        int bin = (int)(nTruePU+1);
+        nominal = pu_weight;
+        up = hPU_up[bin];
+        down = hPU_down[bin];
+      }, "Pileup_weight_Up", "Pileup_weight_Down");
+  }
+  if(applyGenWeight) {
+    eventWeights.addProvider("GenSign", [this](double& nominal, double& up, double& down) {
+        nominal = up = down = (gen_weight > 0) ? 1.0 : -1.0;
+      });
+  }
+  if(distats["Run"].bfind("ApplyTauIDSF")) {
+    eventWeights.addProvider("TauIDSF", [this](double& nominal, double& up, double& down) {
+        getTauDataMCScaleFactors(nominal, up, down);
+      }, "Tau_weight_Up", "Tau_weight_Down");
+  }
+  if(distats["Run"].bfind("ApplyZBoostSF") && isVSample) {
+    zBoostTable = LookupTable({0, 50, 100, 150, 200, 300, 400, 600},
+                              {1, 1.1192, 1.1034, 1.0675, 1.0637, 1.0242, 0.9453, 0.8579, 0.7822}, true);
+    eventWeights.addProvider("ZBoost", [this](double& nominal, double& up, double& down) {
+        nominal = up = down = getZBoostWeight();
+      });
+  }
+  if(distats["Run"].bfind("ApplyWKfactor") && isWSample) {
+    eventWeights.addProvider("WKfactor", [this](double& nominal, double& up, double& down) {
+        nominal = up = down = getWkfactor();
+      });
+  }
+
+  for(auto isyst: weightSysts) {
+    weightVariants.push_back(eventWeights.variantIndex(syst_names[isyst]));
+  }
+}
+
+////fills the N-1 folder of the only cut the event failed (or the extra one if it passed all of them)
+void Analyzer::fill_NMinusOne() {
+  int ncuts = histo.get_cutorder()->size();
+  uint64_t allCuts = (ncuts == 64) ? ~0ULL : (1ULL << ncuts) - 1;
+  uint64_t failed = allCuts & ~cutMask;
+
+  nminus1_histo.addCutMask(cutMask, wgt);
+  if(failed & (failed - 1)) return;
+
+  int slot = ncuts;
+  if(failed != 0) slot = __builtin_ctzll(failed);
+  for(auto it: *nminus1_histo.get_groups()) {
+    fill_Folder(it, slot, nminus1_histo, true);
+  }
+}
+
+////side file with the cut mask of every event, so the cut order can be studied without the ntuple:
+////  header: "BSMCUTMK", int32 version, int32 number of cuts, then each cut name as int32 length + chars
+////  record: int32 entry, (ncuts+7)/8 bytes of mask (little endian), double weight
+void Analyzer::openCutMaskFile(std::string outfile) {
+  std::string name = outfile;
+  size_t ext = name.rfind(".root");
+  if(ext != std::string::npos) name.erase(ext);
+  name += "_cutmask.bin";
+
+  cutMaskOut = new std::ofstream(name, std::ios::binary);
+  if(!(*cutMaskOut)) {
+    std::cout << "ERROR: can't open the cut mask file " << name << std::endl;
+    exit(1);
+  }
+  const std::vector<std::string>* cut_order = histo.get_cutorder();
+  int32_t version = 1, ncuts = cut_order->size();
+  cutMaskOut->write("BSMCUTMK", 8);
+  cutMaskOut->write((const char*)&version, sizeof(version));
+  cutMaskOut->write((const char*)&ncuts, sizeof(ncuts));
+  for(auto cut: *cut_order) {
+    int32_t length = cut.size();
+    cutMaskOut->write((const char*)&length, sizeof(length));
+    cutMaskOut->write(cut.data(), length);
+  }
+  std::cout << "Writing the cut mask of every event to " << name << std::endl;
+}
+
+void Analyzer::writeCutMask() {
+  int nbytes = (histo.get_cutorder()->size() + 7) / 8;
+  int32_t entry = currentEvent;
+  cutMaskOut->write((const char*)&entry, sizeof(entry));
+  for(int i = 0; i < nbytes; i++) {
+    char byte = (cutMask >> (8*i)) & 0xff;
+    cutMaskOut->put(byte);
+  }
+  cutMaskOut->write((const char*)&wgt, sizeof(wgt));
+}
+
+////normalisation counters of FillRun: all events, gen weight sign sum and event weights
+void Analyzer::fill_RunCounters() {
+  std::string group = "FillRun";
+  if(crbins != 1) {
+    for(int i = 0; i < crbins; i++) {
+      histo.addVal(false, group, i, "Events", 1);
+      if(applyGenWeight) {
+        //put the weighted events in bin 3
+        histo.addVal(2, group,i, "Events", (gen_weight > 0) ? 1.0 : -1.0);
+      }
+      histo.addVal(wgt, group, i, "Weight", 1);
+    }
+  }
+  else{
+    histo.addVal(false, group,histo.get_maxfolder(), "Events", 1);
+    if(applyGenWeight) {
+      //put the weighted events in bin 3
+      histo.addVal(2, group,histo.get_maxfolder(), "Events", (gen_weight > 0) ? 1.0 : -1.0);
+    }
+    histo.addVal(wgt, group, histo.get_maxfolder(), "Weight", 1);
+  }
+}
+
+////events removed by the stitching rule keep counting in the normalisation with their own weight,
+////nothing else is filled for them (their reco branches may not have been read)
+void Analyzer::fill_Rejected() {
+  if(applyGenWeight && gen_weight == 0.0) return;
+  if(cutScanOnly || std::find(histo.get_groups()->begin(), histo.get_groups()->end(), "FillRun") == histo.get_groups()->end()) return;
+
+  pu_weight = (!isData && CalculatePUSystematics) ? hPU[(int)(nTruePU+1)] : 1.0;
+  active_part = &goodParts;
+  eventWeights.evaluate();
+  wgt = eventWeights.nominal();
+  fill_RunCounters();
+}
+
 ///Function that fills up the histograms
 void Analyzer::fill_Folder(std::string group, const int max, Histogramer &ihisto, bool issyst) {
   /*be aware in this function
@@ -1969,24 +2671,7 @@ void Analyzer::fill_Folder(std::string group, const int max, Histogramer &ihisto
    * so each histogram knows the group, max and weight!
    */
   if(group == "FillRun" && (&ihisto==&histo)) {
-    if(crbins != 1) {
-      for(int i = 0; i < crbins; i++) {
-        ihisto.addVal(false, group, i, "Events", 1);
-        if(distats["Run"].bfind("ApplyGenWeight")) {
-          //put the weighted events in bin 3
-          ihisto.addVal(2, group,i, "Events", (gen_weight > 0) ? 1.0 : -1.0);
-        }
-        ihisto.addVal(wgt, group, i, "Weight", 1);
-      }
-    }
-    else{
-      ihisto.addVal(false, group,ihisto.get_maxfolder(), "Events", 1);
-      if(distats["Run"].bfind("ApplyGenWeight")) {
-        //put the weighted events in bin 3
-        ihisto.addVal(2, group,ihisto.get_maxfolder(), "Events", (gen_weight > 0) ? 1.0 : -1.0);
-      }
-      ihisto.addVal(wgt, group, ihisto.get_maxfolder(), "Weight", 1);
-    }
+    fill_RunCounters();
     histAddVal(true, "Events");
     histAddVal(bestVertices, "NVertices");
   } else if(!isData && group == "FillGen") {
@@ -2091,18 +2776,15 @@ void Analyzer::fill_Folder(std::string group, const int max, Histogramer &ihisto
     }
 
     if((part->type != PType::Jet ) && active_part->at(ePos)->size() > 0) {
-      std::vector<std::pair<double, int> > ptIndexVector;
-      for(auto it : *active_part->at(ePos)) {
-        ptIndexVector.push_back(std::make_pair(part->pt(it),it));
+      int first = leading(*part, ePos, 0);
+      int second = leading(*part, ePos, 1);
+      if(first >= 0){
+        histAddVal(part->pt(first), "FirstLeadingPt");
+        histAddVal(part->eta(first), "FirstLeadingEta");
       }
-      sort(ptIndexVector.begin(),ptIndexVector.end());
-      if(ptIndexVector.size()>0){
-        histAddVal(part->pt(ptIndexVector.back().second), "FirstLeadingPt");
-        histAddVal(part->eta(ptIndexVector.back().second), "FirstLeadingEta");
-      }
-      if(ptIndexVector.size()>1){
-        histAddVal(part->pt(ptIndexVector.at(ptIndexVector.size()-2).second), "SecondLeadingPt");
-        histAddVal(part->eta(ptIndexVector.at(ptIndexVector.size()-2).second), "SecondLeadingEta");
+      if(second >= 0){
+        histAddVal(part->pt(second), "SecondLeadingPt");
+        histAddVal(part->eta(second), "SecondLeadingEta");
       }
     }
 
@@ -2228,6 +2910,8 @@ void Analyzer::fill_Folder(std::string group, const int max, Histogramer &ihisto
 
     TLorentzVector part1;
     TLorentzVector part2;
+    kin::MassMethod massMethod = kin::MassMethod::Visible;
+    if(!active_part->at(ePos)->empty()) massMethod = kin::massMethod(distats[digroup].smap.at("HowCalculateMassReco"));
 
     for(auto it : *active_part->at(ePos)) {
 
@@ -2252,14 +2936,15 @@ void Analyzer::fill_Folder(std::string group, const int max, Histogramer &ihisto
       histAddVal(absnormPhi(part2.Phi() - _MET->phi()), "Part2MetDeltaPhi");
       histAddVal(cos(absnormPhi(atan2(part1.Py() - part2.Py(), part1.Px() - part2.Px()) - _MET->phi())), "CosDphi_DeltaPtAndMet");
 
-      double diMass = diParticleMass(part1,part2, distats[digroup].smap.at("HowCalculateMassReco"));
-      if(passDiParticleApprox(part1,part2, distats[digroup].smap.at("HowCalculateMassReco"))) {
+      double diMass = diParticleMass(part1,part2, massMethod);
+      if(passDiParticleApprox(part1,part2, massMethod)) {
         histAddVal(diMass, "ReconstructableMass");
       } else {
         histAddVal(diMass, "NotReconstructableMass");
       }
-      double PZeta = getPZeta(part1,part2).first;
-      double PZetaVis = getPZeta(part1,part2).second;
+      std::pair<double, double> pzeta = getPZeta(part1,part2);
+      double PZeta = pzeta.first;
+      double PZetaVis = pzeta.second;
       histAddVal(calculateLeptonMetMt(part1), "Part1MetMt");
       histAddVal(calculateLeptonMetMt(part2), "Part2MetMt");
       histAddVal(PZeta, "PZeta");
@@ -2284,6 +2969,19 @@ void Analyzer::fill_Folder(std::string group, const int max, Histogramer &ihisto
 
     TLorentzVector part1;
     TLorentzVector part2;
+    kin::MassMethod massMethod = kin::MassMethod::Visible;
+    if(!active_part->at(ePos)->empty()) massMethod = kin::massMethod(distats[digroup].smap.at("HowCalculateMassReco"));
+
+    ////MT2 of all pairs in one go, only if it is booked
+    bool fillMT2 = ihisto.hasHist(group, "MT2");
+    if(fillMT2) {
+      mt2Inputs.clear();
+      for(auto it : *active_part->at(ePos)) {
+        mt2Inputs.push_back(MT2::makeInput(lep1->p4(it / BIG_NUM), lep2->p4(it % BIG_NUM), _MET->px(), _MET->py()));
+      }
+      _MET->MT2(mt2Inputs, mt2Values);
+    }
+    size_t ipair = 0;
 
     for(auto it : *active_part->at(ePos)) {
 
@@ -2293,6 +2991,7 @@ void Analyzer::fill_Folder(std::string group, const int max, Histogramer &ihisto
       part1 = lep1->p4(p1);
       part2 = lep2->p4(p2);
 
+      if(fillMT2) histAddVal(mt2Values[ipair++], "MT2");
       histAddVal2(part1.Pt(),part2.Pt(), "Part1PtVsPart2Pt");
       histAddVal(part1.DeltaR(part2), "DeltaR");
       if(group.find("Di") != std::string::npos) {
@@ -2313,8 +3012,8 @@ void Analyzer::fill_Folder(std::string group, const int max, Histogramer &ihisto
       histAddVal(absnormPhi(part2.Phi() - _MET->phi()), "Part2MetDeltaPhi");
       histAddVal(cos(absnormPhi(atan2(part1.Py() - part2.Py(), part1.Px() - part2.Px()) - _MET->phi())), "CosDphi_DeltaPtAndMet");
 
-      double diMass = diParticleMass(part1,part2, distats[digroup].smap.at("HowCalculateMassReco"));
-      if(passDiParticleApprox(part1,part2, distats[digroup].smap.at("HowCalculateMassReco"))) {
+      double diMass = diParticleMass(part1,part2, massMethod);
+      if(passDiParticleApprox(part1,part2, massMethod)) {
         histAddVal(diMass, "ReconstructableMass");
       } else {
         histAddVal(diMass, "NotReconstructableMass");
@@ -2326,8 +3025,9 @@ void Analyzer::fill_Folder(std::string group, const int max, Histogramer &ihisto
       double ptSum = part1.Pt() + part2.Pt();
       histAddVal(ptSum, "SumOfPt");
 
-      double PZeta = getPZeta(part1,part2).first;
-      double PZetaVis = getPZeta(part1,part2).second;
+      std::pair<double, double> pzeta = getPZeta(part1,part2);
+      double PZeta = pzeta.first;
+      double PZetaVis = pzeta.second;
       histAddVal(calculateLeptonMetMt(part1), "Part1MetMt");
       histAddVal(calculateLeptonMetMt(part2), "Part2MetMt");
       histAddVal(lep2->charge(p2) * lep1->charge(p1), "OSLS");
@@ -2539,9 +3239,10 @@ void Analyzer::initializeWkfactor(std::vector<std::string> infiles) {
   TFile k_mu("Pileup/k_faktors_mu.root");
   TFile k_tau("Pileup/k_faktors_tau.root");
 
-  k_ele_h =dynamic_cast<TH1D*>(k_ele.FindObjectAny("k_fac_m"));
-  k_mu_h  =dynamic_cast<TH1D*>(k_mu.FindObjectAny("k_fac_m"));
-  k_tau_h =dynamic_cast<TH1D*>(k_tau.FindObjectAny("k_fac_m"));
+  ////copied into flat tables before the files are closed
+  kFactorEle = LookupTable(dynamic_cast<TH1D*>(k_ele.FindObjectAny("k_fac_m")));
+  kFactorMu  = LookupTable(dynamic_cast<TH1D*>(k_mu.FindObjectAny("k_fac_m")));
+  kFactorTau = LookupTable(dynamic_cast<TH1D*>(k_tau.FindObjectAny("k_fac_m")));
 
   k_ele.Close();
   k_mu.Close();
@@ -2551,10 +3252,7 @@ void Analyzer::initializeWkfactor(std::vector<std::string> infiles) {
 
 ///Normalizes phi to be between -PI and PI
 double normPhi(double phi) {
-  static double const TWO_PI = TMath::Pi() * 2;
-  while ( phi <= -TMath::Pi() ) phi += TWO_PI;
-  while ( phi >  TMath::Pi() ) phi -= TWO_PI;
-  return phi;
+  return kin::normPhi(phi);
 }
 
 
@@ -2,6 +2,7 @@
 #define Analyzer_h
 
 struct CRTester;
+class CutScanner;
 
 // system include files
 #include <memory>
@@ -15,6 +16,8 @@ struct CRTester;
 #include <stdlib.h>
 #include <iostream>
 #include <chrono>
+#include <cmath>
+#include <random>
 
 #include <TDirectory.h>
 #include <TEnv.h>
@@ -33,9 +36,17 @@ struct CRTester;
 #include "Cut_enum.h"
 #include "FillInfo.h"
 #include "CRTest.h"
+#include "CutScan.h"
+#include "Bootstrap.h"
+#include "WeightEngine.h"
 #include "Systematics.h"
+#include "SystRegistry.h"
 #include "JetScaleResolution.h"
 #include "DepGraph.h"
+#include "Kinematics.h"
+#include "CutOrder.h"
+#include "AllocationCounter.h"
+#include "FileHooks.h"
 
 double normPhi(double phi);
 double absnormPhi(double phi);
@@ -43,25 +54,106 @@ double absnormPhi(double phi);
 //#define const
 //using namespace std;
 
+////result of a selection for every object in the nominal pass and the pt range in which it
+////stays the same, systematic passes copy it for objects that are only rescaled within that range
+struct NominalSelection {
+  bool reusable = false;
+  std::vector<char> pass;
+  std::vector<double> ptLow, ptHigh, eta, phi;
+
+  void clear() {
+    pass.clear(); ptLow.clear(); ptHigh.clear(); eta.clear(); phi.clear();
+  }
+  ////[low, high] is the pt range that passes, only if the pt was tested at all
+  void record(const TLorentzVector& lvec, bool passed, bool ptTested, double low, double high) {
+    double pt = lvec.Pt(), from = -HUGE_VAL, to = HUGE_VAL;
+    if(ptTested && pt < low) to = std::nextafter(low, -HUGE_VAL);
+    else if(ptTested && pt > high) from = std::nextafter(high, HUGE_VAL);
+    else if(ptTested) {from = low; to = high;}
+    pass.push_back(passed);
+    ptLow.push_back(from);
+    ptHigh.push_back(to);
+    eta.push_back(lvec.Eta());
+    phi.push_back(lvec.Phi());
+  }
+  bool holds(size_t i, const TLorentzVector& lvec) const {
+    if(i >= pass.size()) return false;
+    double pt = lvec.Pt();
+    return pt >= ptLow[i] && pt <= ptHigh[i] && sameDirection(i, lvec);
+  }
+  bool sameDirection(size_t i, const TLorentzVector& lvec) const {
+    return i < pass.size() && fabs(lvec.Eta() - eta[i]) < 1e-9 && fabs(normPhi(lvec.Phi() - phi[i])) < 1e-9;
+  }
+};
+
+////selections made from the same objects (Elec1 and Elec2, Jet1/Jet2/CentralJet, ...), done in one pass
+////over the objects.  Cuts that are the same in several of them (same cut and values) share a slot
+////and are evaluated once per object.
+struct SiblingGroup {
+  std::vector<CUTS> ePos;
+  std::vector<const PartStats*> stats;
+
+  bool built = false;
+  ////[sibling][cut]: cut codes, slot of their result
+  std::vector<std::vector<int> > codes, slots;
+  std::vector<std::string> keys;
+  std::vector<double> etaHigh, ptLow, ptHigh, isoFirst, isoSecond;
+  std::vector<NominalSelection*> nominals;
+  std::vector<CutOrder*> orders;
+  ////jets only: siblings that drop the selected b-jets, and the generator of each sibling for the
+  ////b-tag scale factor, seeded with its CUTS value so its draws don't depend on the other siblings
+  std::vector<char> removeBJets;
+  std::vector<std::mt19937> random;
+
+  ////per call
+  std::vector<char> active, reuse;
+  std::vector<signed char> results;
+
+  void add(CUTS pos, const PartStats& stat) {ePos.push_back(pos); stats.push_back(&stat);}
+  int slot(const std::string& key) {
+    for(size_t i = 0; i < keys.size(); i++) if(keys[i] == key) return i;
+    keys.push_back(key);
+    return keys.size()-1;
+  }
+  void newObject() {results.assign(keys.size(), -1);}
+  double uniform(size_t sibling) {return std::uniform_real_distribution<double>(0., 1.)(random[sibling]);}
+  template <class F> bool shared(size_t sibling, int k, F&& cut) {
+    signed char& result = results[slots[sibling][k]];
+    if(result < 0) result = cut();
+    return result;
+  }
+};
+
 static const int nTrigReq = 2;
 
 class Analyzer {
   friend class CRTester;
+  friend class CutScanner;
 public:
-  Analyzer(std::vector<std::string>, std::string, bool setCR = false, std::string configFolder="PartDet");
+  Analyzer(std::vector<std::string>, std::string, bool setCR = false, std::string configFolder="PartDet", Analyzer* sharedInput=nullptr, bool cutScan=false);
   ~Analyzer();
+  ////DoCutScan: the scan runs in its own copy of the configuration (cutScan), made by main
+  bool runsCutScan() const {return wantsCutScan;}
   void clear_values();
-  void preprocess(int);
+  ////false for events removed by the stitching rule, they only go into fill_Rejected
+  bool preprocess(int);
   bool fillCuts(bool);
   void printCuts();
   void writeout();
   int nentries;
   void fill_efficiency();
   void fill_histogram();
+  void fill_Rejected();
   void fill_Tree();
+  void fill_NMinusOne();
+  void fill_WeightSysts();
+  void openCutMaskFile(std::string);
+  void writeCutMask();
   void setControlRegions() { histo.setControlRegions();}
 
   std::vector<int>* getList(CUTS ePos) {return goodParts[ePos];}
+  ////k-th highest pt object (0 is the leading one) of a selection of the current systematic, -1 if there are fewer
+  int leading(const Particle&, CUTS, size_t k);
   double getMet() {return _MET->pt();}
   double getHT() {return _MET->HT();}
   double getMHT() {return _MET->MHT();}
@@ -77,6 +169,7 @@ public:
   ///// Functions /////
   //void fill_Folder(std::string, const int, std::string syst="");
   void fill_Folder(std::string, const int, Histogramer& ihisto, bool issyst);
+  void fill_RunCounters();
 
   void getInputs();
   void setupJob(std::string);
@@ -86,8 +179,11 @@ public:
 
   void read_info(std::string);
   void setupGeneral();
-  void initializeTrigger();
+  void updateTriggerMenu();
+  void decodeTriggers();
   void setCutNeeds();
+  void setSystDependencies();
+  void unBranch(Particle*);
 
   void smearLepton(Lepton&, CUTS, const PartStats&, const PartStats&, int syst=0);
   void smearJet(Particle&, CUTS, const PartStats&, int syst=0);
@@ -103,29 +199,56 @@ public:
   void getGoodParticles(int);
   void getGoodTauNu();
   void getGoodGen(const PartStats&);
-  void getGoodRecoLeptons(const Lepton&, const CUTS, const CUTS, const PartStats&, const int);
-  void getGoodRecoJets(CUTS, const PartStats&, const int);
+  ////selections written for the concrete class (Electron, Muon, Taus), no type checks or virtual calls per candidate
+  template <class T> void getGoodRecoLeptons(const T&, SiblingGroup&, const CUTS, const int);
+  void getGoodRecoJets(SiblingGroup&, const int);
+  void getLeadingJet(CUTS, const int);
   void getGoodRecoFatJets(CUTS, const PartStats&, const int);
 
-  void getGoodLeptonCombos(Lepton&, Lepton&, CUTS, CUTS, CUTS, const PartStats&, const int);
+  ////lepton cuts (bset of Elec1, Tau2, ...) turned into codes once
+  enum class LepCut {MatchToGen, Iso, ZDecay, MetDphi, MetMt, MuonTightID, MuonSoftID, ElecVetoID, ElecLooseID, ElecMediumID, ElecTightID, ElecHEEPID,
+      TauCrack, TauDz, TauLeadTrack, TauAgainstElec, TauIsElec, TauAgainstMuon, TauIsMuon, TauProng, TauNewDMs, TauDMF,
+      OverlapMuon1, OverlapMuon2, OverlapElec1, OverlapElec2};
+  const std::vector<LepCut>& leptonCuts(CUTS, PType, const PartStats&, bool);
+  std::string leptonCutKey(LepCut, CUTS, const PartStats&);
+  void buildLeptonGroup(SiblingGroup&, PType, bool);
+
+  ////jet cuts of Jet_info.in
+  enum class JetCut {BTag, MatchBToGen, LooseID, OverlapMuon1, OverlapMuon2, OverlapElec1, OverlapElec2, OverlapTau1, OverlapTau2, BtagSF};
+  void buildJetGroup(SiblingGroup&);
+  bool passLeptonCut(const Electron&, LepCut, int, const TLorentzVector&, CUTS, const PartStats&);
+  bool passLeptonCut(const Muon&, LepCut, int, const TLorentzVector&, CUTS, const PartStats&);
+  bool passLeptonCut(const Taus&, LepCut, int, const TLorentzVector&, CUTS, const PartStats&);
+
+  template <class T1, class T2> void getGoodLeptonCombos(T1&, T2&, CUTS, CUTS, CUTS, const PartStats&, const int);
   void getGoodLeptonJetCombos(Lepton&, Jet&, CUTS, CUTS, CUTS, const PartStats&, const int);
   void getGoodDiJets(const PartStats&, const int);
 
   void VBFTopologyCut(const PartStats&, const int);
-  void TriggerCuts(std::vector<int>&, const std::vector<std::string>&, CUTS);
+  void TriggerCuts(const std::vector<uint64_t>&, CUTS);
 
 
   double calculateLeptonMetMt(const TLorentzVector&);
   double diParticleMass(const TLorentzVector&, const TLorentzVector&, std::string);
+  double diParticleMass(const TLorentzVector&, const TLorentzVector&, kin::MassMethod);
   bool passDiParticleApprox(const TLorentzVector&, const TLorentzVector&, std::string);
+  bool passDiParticleApprox(const TLorentzVector&, const TLorentzVector&, kin::MassMethod);
   bool isZdecay(const TLorentzVector&, const Lepton&);
 
   bool isOverlaping(const TLorentzVector&, Lepton&, CUTS, double);
+  void fillEtaPhi(Particle&, const std::vector<int>&, std::vector<double>&, std::vector<double>&);
+  bool overlapsUnchanged(const PartStats&);
+  bool pairInputsUnchanged(const Particle&, const Particle&, CUTS, CUTS);
+  bool pairCutsInvariant(const PartStats&);
   bool passProng(std::string, int);
   bool isInTheCracks(float);
   bool passedLooseJetID(int);
   bool select_mc_background();
-  double getTauDataMCScaleFactor(int updown);
+  void readStitchBranches(int);
+  void newFile(TTree*);
+  void printFileStats();
+  void getTauDataMCScaleFactors(double&, double&, double&);
+  void setupEventWeights();
   double getWkfactor();
   double getZBoostWeight();
 
@@ -133,6 +256,8 @@ public:
   void create_fillInfo();
 
   inline bool passCutRange(std::string, double, const PartStats&);
+  std::string cutName(CUTS);
+  std::string pinnedCutOrder(const PartStats&);
   bool passCutRange(double, const std::pair<double, double>&);
   bool findCut(const std::vector<std::string>&, std::string);
 
@@ -147,8 +272,9 @@ public:
   ///// values /////
 
   TChain* BOOM;
+  ////false if the chain is read by another configuration (-C cfgA,cfgB)
+  bool ownsInput = true;
   TTree* BAAM;
-  TFile* infoFile;
   std::string filespace = "";
   double hPU[200];
   double hPU_up[200];
@@ -164,11 +290,46 @@ public:
   Met* _MET;
   Histogramer histo;
   Histogramer syst_histo;
+  ////folders of events failing only one cut, filled if FillNMinusOne is set
+  Histogramer nminus1_histo;
+  bool doNMinusOne = false;
+  ////bit i is set if cut i of Cuts.in passed, regardless of the cuts before it
+  uint64_t cutMask = 0;
+  std::ofstream* cutMaskOut = nullptr;
+  int currentEvent = 0;
+  ////events of the current file, for the statistics printed when the file is done
+  std::string fileName;
+  long fileEvents = 0;
+  std::chrono::time_point<std::chrono::system_clock> fileStart;
   std::unordered_map<CUTS, std::vector<int>*, EnumHash>* active_part;
   static const std::unordered_map<std::string, CUTS> cut_num;
 
   Systematics systematics;
   JetScaleResolution jetScaleRes;
+  ////shifts of all JES sources for the jets of the event, [jet*nJesSources + source]
+  int nJesSources = 0;
+  std::vector<double> jesUp, jesDown;
+  ////operator new calls per event of the whole job (PROFILE_ALLOCS builds), kept by the input owner
+  AllocationCounter allocCounter;
+  ////pt order of the selections asked for by leading(), only sorted as far as needed
+  struct PtOrder {
+    const std::vector<int>* list;
+    std::vector<int> order;
+    size_t sorted;
+  };
+  std::vector<PtOrder> ptOrders;
+  size_t nPtOrders = 0;
+  ////names of the efficiency histograms of fill_efficiency, [gen lepton][histogram]
+  std::vector<std::vector<std::string> > effNames;
+  ////decisions of the nominal pass copied by the scale and resolution systematics (ReuseNominalSelection)
+  bool reuseNominal = false;
+  std::unordered_map<CUTS, NominalSelection, EnumHash> nominalSelection;
+  std::unordered_map<CUTS, bool, EnumHash> nominalPairReusable;
+  std::unordered_map<CUTS, std::vector<LepCut>, EnumHash> leptonCutCodes;
+  SiblingGroup electronSelections, muonSelections, tauSelections, bJetSelections, jetSelections;
+  ////order of the cuts of each selection, measured over the first cutOrderWarmup candidates
+  std::unordered_map<CUTS, CutOrder, EnumHash> cutOrders;
+  int cutOrderWarmup = 0;
   PartStats genStat;
 
   std::unordered_map<std::string, PartStats> distats;
@@ -178,12 +339,14 @@ public:
   std::vector<std::unordered_map<CUTS, std::vector<int>*, EnumHash>> syst_parts;
   std::unordered_map<CUTS, bool, EnumHash> need_cut;
 
-  std::unordered_map<std::string,bool> gen_selection;
+  ////gen mass of the stitching rule of the sample, -1 if none
+  double stitchMaxMass = -1;
+  std::vector<TBranch*> stitchBranches;
   std::regex genName_regex;
 
-  TH1D* k_ele_h;
-  TH1D* k_mu_h;
-  TH1D* k_tau_h;
+  LookupTable kFactorEle, kFactorMu, kFactorTau, zBoostTable;
+  WeightEngine eventWeights;
+  bool applyGenWeight = false;
 
   bool isVSample;
   bool isWSample;
@@ -191,17 +354,36 @@ public:
 
   std::vector<Particle*> allParticles;
   std::vector<std::string> syst_names;
+  ////kind, direction and affected cuts of every systematic, read once from its name
+  SystRegistry systs;
+  ////weight-only systematics are filled as weight columns of the nominal pass
+  std::vector<int> weightSysts;
+  std::vector<double> weightScales;
+  std::vector<int> weightVariants;
   std::map<CUTS, Particle* >  particleCutMap;
   DepGraph neededCuts;
 
   static const std::unordered_map<CUTS, std::vector<CUTS>, EnumHash> adjList;
 
-  std::vector<int>* trigPlace[nTrigReq];
   bool setTrigger = false;
   std::vector<std::string>* trigName[nTrigReq];
+  ////bits of the requested triggers (Trigger1/Trigger2) for every trigger menu seen, by the hash of the names
+  struct TriggerMenu {
+    std::vector<std::string> names;
+    std::vector<uint64_t> masks[nTrigReq];
+  };
+  std::unordered_map<size_t, TriggerMenu> triggerMenus;
+  const TriggerMenu* triggerMenu = nullptr;
+  std::vector<uint64_t> firedTriggers;
   std::vector<int> cuts_per, cuts_cumul;
 
   std::unordered_map< std::string,float > zBoostTree;
+  ////per pair MT2 of the Dipart groups, kept to reuse the memory
+  std::vector<MT2::Input> mt2Inputs;
+  std::vector<double> mt2Values;
+  ////eta/phi arrays for the kin:: functions: overlap checks and the Delta R of pair selections
+  std::vector<double> overlapEta, overlapPhi;
+  std::vector<double> pairEta1, pairPhi1, pairEta2, pairPhi2, pairDeltaR2;
 
   double maxIso, minIso;
   int leadIndex, maxCut, crbins=1;
@@ -210,9 +392,17 @@ public:
   std::vector<int>* Trigger_decision = 0;
   std::vector<int>* Trigger_decisionV1 = 0;
   std::vector<std::string>* Trigger_names = 0;
+  LazyBranch<std::vector<std::string> > Trigger_namesV2;
   float nTruePU = 0;
   int bestVertices = 0;
   double gen_weight = 0;
+  std::vector<double>* pdf_weights = 0;
+  bool usePdfWeights = false;
+  bool useBootstrap = false;
+  std::string bootstrapBranch = "eventNumber";
+  ////leaf of the event number in the current file, found again in newFile
+  TLeaf* bootstrapLeaf = nullptr;
+  Bootstrap* bootstrap = nullptr;
 
   BTagCalibration calib = BTagCalibration("csvv1", "Pileup/btagging.csv");
   BTagCalibrationReader reader = BTagCalibrationReader(BTagEntry::OP_TIGHT, "central");
@@ -222,10 +412,16 @@ public:
   const static std::vector<CUTS> genCuts;
   const static std::vector<CUTS> jetCuts;
   const static std::vector<CUTS> nonParticleCuts;
+  ////RemoveOverlapWith... option and the selection it removes against
+  const static std::vector<std::pair<std::string, CUTS> > overlapNames;
   double pu_weight, wgt, backup_wgt;
   std::unordered_map<int, GenFill*> genMaper;
 
   std::vector<CRTester*> testVec;
+  CutScanner* scanner = nullptr;
+  ////this copy only runs the cut scan, with the scanned cuts loosened, and writes nothing else
+  bool cutScanOnly = false;
+  bool wantsCutScan = false;
   int SignalRegion = -1;
   bool blinded = true;
   clock_t start_time;
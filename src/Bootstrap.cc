@@ -0,0 +1,96 @@
+#include "Bootstrap.h"
+
+Bootstrap::Bootstrap(int _nreplicas, int _ncuts, uint64_t _seed) : nreplicas(_nreplicas), ncuts(_ncuts), seed(_seed) {
+  if(nreplicas < 1) {
+    std::cout << "ERROR: need at least one bootstrap replica" << std::endl;
+    exit(1);
+  }
+  ////P(X <= k) for X ~ Poisson(1), beyond 15 the probability is below 1e-13
+  double term = exp(-1.), sum = 0;
+  for(int k = 0; k < nPoisson; k++) {
+    sum += term;
+    poissonCDF[k] = sum;
+    term /= (k+1);
+  }
+  replicaWeights.assign(nreplicas, 1.);
+  cutsPer.assign(ncuts*nreplicas, 0);
+  cutsCumul.assign((ncuts+1)*nreplicas, 0);
+}
+
+////splitmix64 finalizer
+uint64_t Bootstrap::mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+void Bootstrap::generate(uint64_t key) {
+  uint64_t base = mix(key ^ mix(seed + 0x9E3779B97F4A7C15ULL));
+  for(int i = 0; i < nreplicas; i++) {
+    double u = (mix(base + (i+1)*0x9E3779B97F4A7C15ULL) >> 11) * (1.0/9007199254740992.0);
+    ////inverse CDF without branches: count the thresholds below u
+    int k = 0;
+    for(int j = 0; j < nPoisson; j++) k += (u >= poissonCDF[j]);
+    replicaWeights[i] = k;
+  }
+}
+
+void Bootstrap::fillCutFlow(uint64_t mask, int maxCut) {
+  for(int c = 0; c < ncuts; c++) {
+    if(!(mask & (1ULL << c))) continue;
+    double* per = &cutsPer[c*nreplicas];
+    for(int i = 0; i < nreplicas; i++) per[i] += replicaWeights[i];
+  }
+  if(maxCut <= 0) return;
+  if(maxCut > ncuts) maxCut = ncuts;
+  double* cumul = &cutsCumul[maxCut*nreplicas];
+  for(int i = 0; i < nreplicas; i++) cumul[i] += replicaWeights[i];
+}
+
+////slot c holds the events that passed exactly the first c cuts, cut c-1 gets all slots >= c
+void Bootstrap::fold() {
+  if(folded) return;
+  for(int c = ncuts-1; c >= 0; c--) {
+    for(int i = 0; i < nreplicas; i++) cutsCumul[c*nreplicas+i] += cutsCumul[(c+1)*nreplicas+i];
+  }
+  ////shift so cut c is in slot c
+  cutsCumul.erase(cutsCumul.begin(), cutsCumul.begin()+nreplicas);
+  folded = true;
+}
+
+double Bootstrap::cumulativeRMS(int cut) {
+  fold();
+  if(cut < 0 || cut >= ncuts || nreplicas < 2) return 0;
+  double sum = 0, sum2 = 0;
+  for(int i = 0; i < nreplicas; i++) {
+    double val = cutsCumul[cut*nreplicas+i];
+    sum += val;
+    sum2 += val*val;
+  }
+  double mean = sum/nreplicas;
+  return sqrt(std::max(0., (sum2 - nreplicas*mean*mean)/(nreplicas-1)));
+}
+
+void Bootstrap::write(std::string outname, const std::vector<std::string>& cut_order) {
+  fold();
+  TH2D indiv("CutFlowIndiv", "CutFlowIndiv", ncuts, 0, ncuts, nreplicas, -0.5, nreplicas-0.5);
+  TH2D cumul("CutFlowCumulative", "CutFlowCumulative", ncuts, 0, ncuts, nreplicas, -0.5, nreplicas-0.5);
+  for(int c = 0; c < ncuts; c++) {
+    if(c < (int)cut_order.size()) {
+      indiv.GetXaxis()->SetBinLabel(c+1, cut_order[c].c_str());
+      cumul.GetXaxis()->SetBinLabel(c+1, cut_order[c].c_str());
+    }
+    for(int i = 0; i < nreplicas; i++) {
+      indiv.SetBinContent(c+1, i+1, cutsPer[c*nreplicas+i]);
+      cumul.SetBinContent(c+1, i+1, cutsCumul[c*nreplicas+i]);
+    }
+  }
+
+  TFile* outfile = new TFile(outname.c_str(), "UPDATE");
+  if(outfile->GetDirectory("Bootstrap") == nullptr) outfile->mkdir("Bootstrap");
+  outfile->cd("Bootstrap");
+  indiv.Write();
+  cumul.Write();
+  outfile->Close();
+  delete outfile;
+}
@@ -0,0 +1,64 @@
+#ifndef Bootstrap_h
+#define Bootstrap_h
+
+#include <TFile.h>
+#include <TH2.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+/*
+Bootstrap: Poisson(1) replica weights for statistical uncertainties.
+
+Every event gets N weights drawn from a counter-based generator: the i-th weight of an
+event only depends on the seed, the event number and i, so the replicas are the same in
+every job and the outputs of several jobs can be added (hadd) like the nominal histograms.
+
+generate(uint64_t key)
+  Makes the N weights of the event with this key (the event number).
+
+weights()
+  Weights of the current event, used as the per event weights of the histograms marked
+  'weights' in Hist_entries.in.
+
+fillCutFlow(uint64_t mask, int maxCut)
+  Adds the current weights to the individual (bit i of mask set) and cumulative (i < maxCut)
+  count of every cut.  The cumulative count is only filled in slot maxCut and summed up when
+  it is needed, same as the cumulative folders.
+
+write(std::string outname, cut names)
+  Writes Bootstrap/CutFlowIndiv and Bootstrap/CutFlowCumulative (cut x replica).
+*/
+class Bootstrap {
+ public:
+  Bootstrap(int nreplicas, int ncuts, uint64_t seed=0);
+
+  void generate(uint64_t key);
+  const std::vector<double>& weights() const {return replicaWeights;}
+  int size() const {return nreplicas;}
+
+  void fillCutFlow(uint64_t mask, int maxCut);
+  double cumulativeRMS(int cut);
+  void write(std::string outname, const std::vector<std::string>& cut_order);
+
+ private:
+  static const int nPoisson = 16;
+
+  int nreplicas, ncuts;
+  uint64_t seed;
+  double poissonCDF[nPoisson];
+  std::vector<double> replicaWeights;
+
+  ////[cut][replica]
+  std::vector<double> cutsPer, cutsCumul;
+  bool folded = false;
+
+  static uint64_t mix(uint64_t);
+  void fold();
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "BranchRegistry.h"
+
+////one registry per tree, shared by every Analyzer running over it
+static std::unordered_map<TTree*, BranchRegistry>& registries() {
+  static std::unordered_map<TTree*, BranchRegistry> regs;
+  return regs;
+}
+
+BranchRegistry& BranchRegistry::get(TTree* tree) {
+  auto found = registries().find(tree);
+  if(found == registries().end()) {
+    found = registries().emplace(tree, BranchRegistry(tree)).first;
+  }
+  return found->second;
+}
+
+void BranchRegistry::release(TTree* tree) {
+  registries().erase(tree);
+}
+
+void BranchRegistry::printLazyStats(long nentries) const {
+  if(lazyOrder.empty()) return;
+  std::cout << "\nBranches read on access (events read / total):" << std::endl;
+  for(auto slot: lazyOrder) {
+    std::cout << "  " << slot->name << ": " << slot->events << " / " << nentries;
+    if(nentries > 0) std::cout << " (" << 100.*slot->events/nentries << "%)";
+    std::cout << std::endl;
+  }
+}
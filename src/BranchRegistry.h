@@ -0,0 +1,143 @@
+#ifndef BRANCH_REGISTRY_H_
+#define BRANCH_REGISTRY_H_
+
+#include <TTree.h>
+#include <TBranch.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <typeinfo>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+
+/*
+BranchRegistry: keeps track of the variable every branch of a tree is read into.
+
+ROOT only knows one address per branch, so when several configurations run over the same
+chain (-C cfgA,cfgB) the first object that binds a branch owns the address ROOT fills.
+Any later object binding the same branch becomes an alias and gets the value copied over
+by sync(), which has to be called after each GetEntry.  With a single configuration there
+are no aliases and bind() is the same as SetBranchStatus + SetBranchAddress.
+
+bind(std::string name, T& variable)
+  Activates the branch and reads it into variable (or aliases variable to the owner).
+
+sync()
+  Copies the owners' values into all aliases.
+
+release(TTree*)
+  Forgets the registry of a tree, called when the tree is deleted.
+
+bindLazy<T>(std::string name) / load(slot)
+  Branches read only when asked for (see LazyBranch).  The branch stays switched off for
+  GetEntry, load() reads it for the entry the tree is at, once per entry.  There is one slot
+  per branch, every configuration reading it uses the same one.
+
+printLazyStats(nentries)
+  Number of events each lazy branch was read in.
+*/
+class BranchRegistry {
+public:
+  BranchRegistry(TTree* _tree) : tree(_tree) {}
+
+  static BranchRegistry& get(TTree*);
+  static void release(TTree*);
+
+  template <typename T>
+  void bind(const std::string& name, T& variable) {
+    tree->SetBranchStatus(name.c_str(), 1);
+    auto found = owners.find(name);
+    if(found == owners.end()) {
+      tree->SetBranchAddress(name.c_str(), &variable);
+      owners.emplace(name, Owner{&variable, sizeof(T), typeid(T).hash_code()});
+      return;
+    }
+    if(found->second.address == &variable) return;
+    if(found->second.type != typeid(T).hash_code()) {
+      std::cout << "ERROR: branch " << name << " is bound with two different types" << std::endl;
+      exit(1);
+    }
+    aliases.push_back(Alias{&variable, found->second.address, sizeof(T)});
+  }
+
+  void sync() {
+    for(auto& alias: aliases) memcpy(alias.target, alias.source, alias.size);
+  }
+
+  bool isBound(const std::string& name) const {return owners.find(name) != owners.end();}
+  bool hasAliases() const {return !aliases.empty();}
+
+  struct LazySlot {
+    std::string name;
+    size_t type;
+    TBranch* branch = nullptr;
+    int treeNumber = -1;
+    long long entry = -1;
+    long events = 0;
+    virtual ~LazySlot() {}
+  };
+  template <typename T> struct TypedSlot : LazySlot {
+    T* value = nullptr;
+  };
+
+  template <typename T>
+  TypedSlot<T>& bindLazy(const std::string& name) {
+    auto found = lazy.find(name);
+    if(found == lazy.end()) {
+      if(isBound(name)) {
+        std::cout << "ERROR: branch " << name << " is read both on every entry and on access" << std::endl;
+        exit(1);
+      }
+      TypedSlot<T>* slot = new TypedSlot<T>();
+      slot->name = name;
+      slot->type = typeid(T).hash_code();
+      tree->SetBranchStatus(name.c_str(), 0);
+      tree->SetBranchAddress(name.c_str(), &slot->value);
+      found = lazy.emplace(name, std::unique_ptr<LazySlot>(slot)).first;
+      lazyOrder.push_back(slot);
+    }
+    if(found->second->type != typeid(T).hash_code()) {
+      std::cout << "ERROR: branch " << name << " is bound with two different types" << std::endl;
+      exit(1);
+    }
+    return static_cast<TypedSlot<T>&>(*found->second);
+  }
+
+  void load(LazySlot& slot) {
+    long long entry = tree->GetReadEntry();
+    if(slot.entry == entry) return;
+    slot.entry = entry;
+    slot.events++;
+    long long local = tree->LoadTree(entry);
+    if(tree->GetTreeNumber() != slot.treeNumber) {
+      slot.treeNumber = tree->GetTreeNumber();
+      slot.branch = tree->GetTree()->GetBranch(slot.name.c_str());
+    }
+    ////getall: read even though the branch is switched off
+    if(slot.branch != nullptr && local >= 0) slot.branch->GetEntry(local, 1);
+  }
+
+  void printLazyStats(long nentries) const;
+
+private:
+  struct Owner {
+    void* address;
+    size_t size;
+    size_t type;
+  };
+  struct Alias {
+    void* target;
+    const void* source;
+    size_t size;
+  };
+
+  TTree* tree;
+  std::unordered_map<std::string, Owner> owners;
+  std::vector<Alias> aliases;
+  std::unordered_map<std::string, std::unique_ptr<LazySlot> > lazy;
+  std::vector<const LazySlot*> lazyOrder;
+};
+
+#endif
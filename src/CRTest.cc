@@ -3,30 +3,23 @@
 
 
 bool CRTester::partPassBoth(Analyzer* analyzer) {
-  int diffsize = 0;
   CUTS ePart1;
   CUTS ePart2;
   if(partName == "Muon1Muon2") {
     ePart1 = CUTS::eRMuon1;
     ePart2 = CUTS::eRMuon2;
-    diffsize = analyzer->_Muon->size();
   } else if(partName == "Electron1Electron2") {
     ePart1 = CUTS::eRElec1;
     ePart2 = CUTS::eRElec2;
-    diffsize = analyzer->_Electron->size();
   } else if(partName == "Tau1Tau2") {
     ePart1 = CUTS::eRTau1;
     ePart2 = CUTS::eRTau2;
-    diffsize = analyzer->_Tau->size();
   }
   std::vector<int>* part1 = analyzer->goodParts[ePart1];
   std::vector<int>* part2 = analyzer->goodParts[ePart2];
-  std::vector<int> diff(diffsize);
 
-  std::vector<int>::iterator it = set_symmetric_difference(part1->begin(), part1->end(), part2->begin(), part2->end(), diff.begin());
-  diff.resize(it - diff.begin());
-
-  return (diff.size() == 0);
+  ////both lists are in index order, no symmetric difference means they are the same
+  return *part1 == *part2;
 }
 
 
@@ -0,0 +1,49 @@
+#include "CutOrder.h"
+#include <algorithm>
+
+void CutOrder::setCuts(std::string _selection, std::vector<std::string> _names, int warmup, const std::string& pinned) {
+  set = true;
+  selection = _selection;
+  names = _names;
+  order.clear();
+  seconds.assign(names.size(), 0.);
+  rejected.assign(names.size(), 0);
+
+  ////pinned cuts first, in the given order
+  size_t start = 0;
+  while(start < pinned.size()) {
+    size_t end = std::min(pinned.find(':', start), pinned.size());
+    std::string name = pinned.substr(start, end - start);
+    start = end + 1;
+    if(name.empty()) continue;
+    int k = std::find(names.begin(), names.end(), name) - names.begin();
+    if(k == (int)names.size() || std::find(order.begin(), order.end(), k) != order.end()) {
+      std::cout << "ERROR: CutOrder of " << selection << ": " << name << " is not a cut of the selection or is listed twice" << std::endl;
+      exit(1);
+    }
+    order.push_back(k);
+  }
+  bool isPinned = !order.empty();
+  for(size_t k = 0; k < names.size(); k++) {
+    if(std::find(order.begin(), order.end(), (int)k) == order.end()) order.push_back(k);
+  }
+  measured = remaining = (names.size() > 1 && !isPinned) ? std::max(warmup, 0) : 0;
+}
+
+void CutOrder::reorder() {
+  ////time per rejected candidate, never rejecting cuts after all others
+  std::vector<double> rank(order.size());
+  for(size_t k = 0; k < order.size(); k++) {
+    rank[k] = (rejected[k] > 0) ? seconds[k] / rejected[k] : HUGE_VAL;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+      if(rank[a] == rank[b] && rejected[a] == 0) return seconds[a] < seconds[b];
+      return rank[a] < rank[b];
+    });
+
+  std::cout << "Cut order for " << selection << " after " << measured << " candidates:";
+  for(int k: order) std::cout << " " << names[k] << "(" << 100.*rejected[k]/measured << "%)";
+  std::cout << std::endl << "  to keep it: CutOrder ";
+  for(size_t k = 0; k < order.size(); k++) std::cout << ((k > 0) ? ":" : "") << names[order[k]];
+  std::cout << std::endl;
+}
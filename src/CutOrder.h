@@ -0,0 +1,72 @@
+#ifndef CutOrder_h
+#define CutOrder_h
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+/*
+CutOrder: order in which the cuts of one selection are tried, learned from the first candidates.
+
+All cuts of a selection are required, so every order gives the same answer.  For the first
+'warmup' candidates each cut is evaluated and timed even after one failed, to get its time and
+how often it rejects.  Then the cuts are sorted by time / rejection rate (cheap cuts that reject
+a lot first, cuts that never rejected last) and the new order is printed as a CutOrder line.
+
+Cuts that are not plain switches of the group (MatchToGen from the Smear group, a
+DiscrByOSLSType given as a number or OS/LS) have no position in the info file, so copying
+the switches in the printed order does not give the learned order back.  Pinning does:
+
+   CutOrder   MatchToGen:DoDiscrByIsolation:DiscrByOSLSType
+
+in the group of the selection tries the listed cuts first, in that order, and the others
+after them in the configured order.  A pinned selection is never reordered.
+
+setCuts(selection, cut names, warmup, pinned)
+  warmup 0 keeps the configured order, pinned is the CutOrder value ("" if not given).
+
+pass(f)
+  f(k) evaluates cut k of the names given to setCuts; true if all cuts pass.
+*/
+class CutOrder {
+ public:
+  void setCuts(std::string selection, std::vector<std::string> names, int warmup, const std::string& pinned="");
+  bool isSet() const {return set;}
+  const std::string& name(int k) const {return names[k];}
+
+  template <class F> bool pass(F&& cut) {
+    if(remaining > 0) return measure(cut);
+    for(int k: order) {
+      if(!cut(k)) return false;
+    }
+    return true;
+  }
+
+ private:
+  template <class F> bool measure(F& cut) {
+    bool passed = true;
+    for(size_t k = 0; k < order.size(); k++) {
+      auto start = std::chrono::steady_clock::now();
+      bool pass = cut(k);
+      seconds[k] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      if(!pass) rejected[k]++;
+      passed = passed && pass;
+    }
+    if(--remaining == 0) reorder();
+    return passed;
+  }
+  void reorder();
+
+  bool set = false;
+  std::string selection;
+  std::vector<std::string> names;
+  std::vector<int> order;
+  long remaining = 0, measured = 0;
+  std::vector<double> seconds;
+  std::vector<long> rejected;
+};
+
+#endif
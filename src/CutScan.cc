@@ -0,0 +1,232 @@
+#include "CutScan.h"
+#include <THn.h>
+#include <algorithm>
+#include <functional>
+#define BIG_NUM 46340
+
+
+CutScanner::CutScanner(Analyzer* _analyzer, std::string filename) : analyzer(_analyzer) {
+  typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+  std::ifstream info_file(filename);
+  boost::char_separator<char> sep(", \t");
+
+  if(!info_file) {
+    std::cout << "ERROR: Didn't Read Scan File!" << std::endl;
+    std::cout << filename << std::endl;
+    exit(1);
+  }
+
+  std::string line;
+  while(getline(info_file, line)) {
+    tokenizer tokens(line, sep);
+    std::vector<std::string> stemp;
+    for(tokenizer::iterator iter = tokens.begin();iter != tokens.end(); iter++) {
+      if( ((*iter)[0] == '/' && (*iter)[0] == '/') || ((*iter)[0] == '#') ) break;
+      stemp.push_back(*iter);
+    }
+    if(stemp.size() == 0) continue;
+    else if(stemp.size() != 4) {
+      std::cout << "Could not process scan line: " << line << std::endl;
+      exit(1);
+    }
+    addAxis(stemp[0], stod(stemp[1]), stod(stemp[2]), stoi(stemp[3]));
+  }
+  info_file.close();
+
+  if(axes.size() == 0) {
+    std::cout << "ERROR: no cuts to scan in " << filename << std::endl;
+    exit(1);
+  }
+
+  int npoints = 1;
+  for(auto it = axes.rbegin(); it != axes.rend(); it++) {
+    it->stride = npoints;
+    npoints *= it->thresholds.size();
+  }
+  sumw.assign(npoints, 0);
+  sumw2.assign(npoints, 0);
+  counts.assign(npoints, 0);
+
+  std::cout << "Scanning " << axes.size() << " cuts over " << npoints << " grid points" << std::endl;
+}
+
+void CutScanner::addAxis(std::string var, double first, double last, int npoints) {
+  std::smatch m;
+  std::regex part ("^(.+)_(.+)$");
+  if(!std::regex_match(var, m, part) || npoints < 1) {
+    std::cout << "Could not process scan variable: " << var << std::endl;
+    exit(1);
+  }
+
+  ScanAxis axis;
+  axis.name = var;
+  axis.partName = m[1];
+  axis.variable = m[2];
+  axis.info = nullptr;
+  axis.strict = true;
+
+  for(int i = 0; i < npoints; i++) {
+    axis.thresholds.push_back( (npoints == 1) ? first : first + i*(last - first)/(npoints - 1));
+  }
+  std::sort(axis.thresholds.begin(), axis.thresholds.end());
+  double loosest = axis.thresholds.front();
+
+  CUTS ePos;
+  if(axis.partName == "Met" && axis.variable == "Met") {
+    ePos = CUTS::eMET;
+    analyzer->distats["Run"].pmap.at("MetCut").first = loosest;
+  } else {
+    auto found = analyzer->fillInfo.find("Fill" + axis.partName);
+    if(found == analyzer->fillInfo.end()) {
+      std::cout << "Fill" << axis.partName << " not found, can't scan " << var << std::endl;
+      exit(1);
+    }
+    axis.info = found->second;
+    ePos = axis.info->ePos;
+
+    if(axis.info->type == FILLER::Single && axis.variable == "Pt") {
+      std::string statName = axis.partName;
+      if(statName.find("Electron") == 0) statName.replace(0, 8, "Elec");
+      PartStats& stats = axis.info->part->pstats[statName];
+      if(stats.pmap.find("PtCut") != stats.pmap.end()) {
+        stats.pmap.at("PtCut").first = loosest;
+        axis.strict = false;
+      } else if(stats.dmap.find("PtCut") != stats.dmap.end()) {
+        stats.dmap.at("PtCut") = loosest;
+      } else {
+        std::cout << "No PtCut found for " << statName << ", can't scan " << var << std::endl;
+        exit(1);
+      }
+    } else if(axis.info->type == FILLER::Dipart && axis.variable == "Mass" && axis.info->part != analyzer->_Jet) {
+      analyzer->distats[axis.partName].pmap.at("MassCut").first = loosest;
+    } else {
+      std::cout << "Scanning " << var << " is not supported (only <particle>_Pt, <lepton pair>_Mass and Met_Met)" << std::endl;
+      exit(1);
+    }
+  }
+
+  ////the number of candidates needed comes from Cuts.in
+  axis.minCount = 0;
+  const std::unordered_map<std::string,std::pair<int,int> >* cut_info = analyzer->histo.get_cuts();
+  for(auto cut: *cut_info) {
+    auto num = Analyzer::cut_num.find(cut.first);
+    if(num == Analyzer::cut_num.end() || num->second != ePos) continue;
+    if(cut.second.second != -1 || cut.second.first < 1) {
+      std::cout << "Scanning " << var << " needs a cut of the form '" << cut.first << " N -1' with N > 0 in Cuts.in" << std::endl;
+      exit(1);
+    }
+    axis.minCount = cut.second.first;
+  }
+  if(axis.minCount == 0) {
+    std::cout << "Scanning " << var << " has no effect, it is not required in Cuts.in" << std::endl;
+    exit(1);
+  }
+
+  for(auto& other: axes) {
+    if(axis.info != nullptr && other.info != nullptr && axis.info->type != other.info->type
+       && (axis.info->part == other.info->part || axis.info->part2 == other.info->part)) {
+      std::cout << "Warning: " << var << " and " << other.name << " are scanned independently" << std::endl;
+    }
+  }
+
+  std::cout << "Scan " << var << " from " << axis.thresholds.front() << " to " << axis.thresholds.back()
+            << " in " << npoints << " points" << std::endl;
+  axes.push_back(axis);
+}
+
+////number of grid points (from the loosest) the event passes for this axis
+int CutScanner::passedPoints(const ScanAxis& axis) {
+  values.clear();
+  if(axis.info == nullptr) {
+    values.push_back(analyzer->getMet());
+  } else {
+    for(auto index: *analyzer->getList(axis.info->ePos)) {
+      if(axis.info->type == FILLER::Single) {
+        values.push_back(axis.info->part->p4(index).Pt());
+      } else {
+        const TLorentzVector& part1 = axis.info->part->p4(index / BIG_NUM);
+        const TLorentzVector& part2 = axis.info->part2->p4(index % BIG_NUM);
+        values.push_back(analyzer->getMass(part1, part2, axis.partName));
+      }
+    }
+  }
+  if((int)values.size() < axis.minCount) return 0;
+
+  std::nth_element(values.begin(), values.begin() + axis.minCount - 1, values.end(), std::greater<double>());
+  double value = values.at(axis.minCount - 1);
+
+  if(axis.strict) return std::lower_bound(axis.thresholds.begin(), axis.thresholds.end(), value) - axis.thresholds.begin();
+  return std::upper_bound(axis.thresholds.begin(), axis.thresholds.end(), value) - axis.thresholds.begin();
+}
+
+void CutScanner::fill(double weight) {
+  int corner = 0;
+  for(auto& axis: axes) {
+    int npassed = passedPoints(axis);
+    if(npassed == 0) return;
+    corner += (npassed - 1) * axis.stride;
+  }
+  sumw[corner] += weight;
+  sumw2[corner] += weight*weight;
+  counts[corner] += 1;
+}
+
+////sum every entry into all points with lower (or equal) thresholds, one axis at a time
+void CutScanner::fold(std::vector<double>& table) {
+  for(auto& axis: axes) {
+    int npoints = axis.thresholds.size();
+    for(int i = (int)table.size() - 1; i >= 0; i--) {
+      if((i / axis.stride) % npoints == npoints - 1) continue;
+      table[i] += table[i + axis.stride];
+    }
+  }
+}
+
+void CutScanner::write(std::string outname) {
+  if(!folded) {
+    fold(sumw);
+    fold(sumw2);
+    fold(counts);
+    folded = true;
+  }
+
+  int ndim = axes.size();
+  std::vector<int> nbins;
+  std::vector<double> xmin, xmax;
+  for(auto& axis: axes) {
+    int npoints = axis.thresholds.size();
+    double step = (npoints > 1) ? (axis.thresholds.back() - axis.thresholds.front())/(npoints - 1) : 1.;
+    nbins.push_back(npoints);
+    xmin.push_back(axis.thresholds.front() - step/2);
+    xmax.push_back(axis.thresholds.back() + step/2);
+  }
+
+  THnD yield("Yield", "Yield", ndim, nbins.data(), xmin.data(), xmax.data());
+  THnD wyield("WeightedYield", "WeightedYield", ndim, nbins.data(), xmin.data(), xmax.data());
+  wyield.Sumw2();
+  for(int i = 0; i < ndim; i++) {
+    if(yield.GetAxis(i) != nullptr) yield.GetAxis(i)->SetTitle(axes[i].name.c_str());
+    if(wyield.GetAxis(i) != nullptr) wyield.GetAxis(i)->SetTitle(axes[i].name.c_str());
+  }
+
+  std::vector<int> coord(ndim);
+  double entries = 0;
+  for(size_t flat = 0; flat < sumw.size(); flat++) {
+    for(int i = 0; i < ndim; i++) coord[i] = (flat / axes[i].stride) % axes[i].thresholds.size() + 1;
+    long long bin = yield.GetBin(coord.data());
+    yield.SetBinContent(bin, counts[flat]);
+    wyield.SetBinContent(bin, sumw[flat]);
+    wyield.SetBinError2(bin, sumw2[flat]);
+    entries = std::max(entries, counts[flat]);
+  }
+  yield.SetEntries(entries);
+  wyield.SetEntries(entries);
+
+  TFile* outfile = new TFile(outname.c_str(), "UPDATE");
+  if(outfile->GetDirectory("Scan") == nullptr) outfile->mkdir("Scan");
+  outfile->cd("Scan");
+  yield.Write();
+  wyield.Write();
+  outfile->Close();
+  delete outfile;
+}
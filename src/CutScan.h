@@ -0,0 +1,57 @@
+#ifndef CutScan_h
+#define CutScan_h
+
+class Analyzer;
+#include "Analyzer.h"
+
+/*
+CutScanner: scans lower thresholds of the selection in one job.
+
+Read from Scan_info.in in the config folder, one scanned cut per line:
+
+   <name>_<variable>   <first>   <last>   <npoints>
+
+with the same names as the control regions: Tau1_Pt, Jet1_Pt, DiTau_Mass, Met_Met, ...
+The scan runs in a second analyzer of the same config folder that shares the input
+(<output>_CutScan.root).  In that copy only, the configured threshold is moved to the
+loosest grid point so its selection keeps every candidate that passes somewhere on the
+grid; the normal output keeps the configured cuts.  For every event passing the full
+selection the value of each scanned variable is recorded once per candidate and the
+m-th largest value is kept, m being the minimum number from Cuts.in.  The event then
+passes every grid point below those values, a box starting at the origin of the grid,
+so only its far corner is filled and the table is summed up towards the origin when
+written (same trick as the cumulative folders).
+
+Cuts on different scanned collections are treated as independent, a pair built from a
+scanned collection is not re-checked when that collection's threshold goes up.
+*/
+class CutScanner {
+ public:
+  CutScanner(Analyzer*, std::string filename);
+  void fill(double weight);
+  void write(std::string outname);
+
+ private:
+  struct ScanAxis {
+    std::string name;
+    const FillVals* info;
+    std::string partName;
+    std::string variable;
+    bool strict;
+    int minCount;
+    std::vector<double> thresholds;
+    int stride;
+  };
+
+  Analyzer* analyzer;
+  std::vector<ScanAxis> axes;
+  std::vector<double> sumw, sumw2, counts;
+  std::vector<double> values;
+  bool folded = false;
+
+  void addAxis(std::string, double, double, int);
+  int passedPoints(const ScanAxis&);
+  void fold(std::vector<double>&);
+};
+
+#endif
@@ -67,6 +67,8 @@ enum class CUTS {
   First = eGen,
   Last = eRTrig2};
 
+enum class PType { Electron, Muon, Tau, Jet, FatJet, None};
+
 static std::unordered_map<CUTS, std::string, EnumHash> enumNames {
   {CUTS::eGen, "eGen"},
   {CUTS::eGTau, "eGTau"}, {CUTS::eGTop, "eGTop"}, {CUTS::eGElec, "eGElec"}, {CUTS::eGMuon, "eGMuon"}, {CUTS::eGZ, "eGZ"},
@@ -26,6 +26,114 @@ void Piece1D::write_histogram(std::vector<std::string>& folders, TFile* outfile,
   }
 }
 
+void Piece1D::fold_cumulative() {
+  for(int i = (int)histograms.size()-2; i >= 0; i--) {
+    histograms.at(i).Add(&histograms.at(i+1));
+  }
+}
+
+void Piece1D::add_slot() {
+  if(histograms.size() == 0) return;
+  histograms.push_back(histograms.front());
+  histograms.back().Reset();
+}
+
+void Piece1D::fold_nminus1() {
+  for(size_t i = 0; i+1 < histograms.size(); i++) {
+    histograms.at(i).Add(&histograms.back());
+  }
+}
+
+/*------------------------------------------------------------------------------------------*/
+
+Piece1DMulti::Piece1DMulti(std::string _name, int _bins, double _begin, double _end, int _nweights, int _Nfold) :
+DataPiece(_name, _Nfold), begin(_begin), end(_end), bins(_bins), nweights(_nweights) {
+  sumw.assign(_Nfold, std::vector<double>((bins+2)*nweights, 0));
+  sumw2.assign(_Nfold, std::vector<double>((bins+2)*nweights, 0));
+  entries.assign(_Nfold, 0);
+}
+
+////same binning as TH1D::Fill, bin 0 and bins+1 are under- and overflow
+void Piece1DMulti::bin(int folder, double y, double weight, const std::vector<double>& weights) {
+  if(y != y) return;
+  int ibin;
+  if(y < begin) ibin = 0;
+  else if(y >= end) ibin = bins+1;
+  else ibin = 1 + (int)(bins*(y-begin)/(end-begin));
+
+  double* w = &sumw.at(folder)[ibin*nweights];
+  double* w2 = &sumw2.at(folder)[ibin*nweights];
+  int n = std::min(nweights, (int)weights.size());
+  for(int k = 0; k < n; k++) {
+    double wk = weight*weights[k];
+    w[k] += wk;
+    w2[k] += wk*wk;
+  }
+  entries.at(folder)++;
+}
+
+void Piece1DMulti::write_histogram(std::vector<std::string>& folders, TFile* outfile, std::string subfolder) {
+  for(int i =0; i < (int)folders.size(); i++) {
+    if(subfolder==""){
+      outfile->cd(folders.at(i).c_str());
+    }else{
+      outfile->cd((subfolder+"/"+folders.at(i)).c_str());
+    }
+    if(asTH2) {
+      std::string hname = name + "_weights";
+      TH2D tmp(hname.c_str(), hname.c_str(), bins, begin, end, nweights, -0.5, nweights-0.5);
+      tmp.Sumw2();
+      for(int ibin = 0; ibin < bins+2; ibin++) {
+        for(int k = 0; k < nweights; k++) {
+          tmp.SetBinContent(ibin, k+1, sumw.at(i)[ibin*nweights+k]);
+          tmp.SetBinError(ibin, k+1, sqrt(sumw2.at(i)[ibin*nweights+k]));
+        }
+      }
+      tmp.SetEntries(entries.at(i));
+      tmp.Write();
+    } else {
+      for(int k = 0; k < nweights; k++) {
+        std::string hname = name + "_w" + std::to_string(k);
+        TH1D tmp(hname.c_str(), hname.c_str(), bins, begin, end);
+        tmp.Sumw2();
+        for(int ibin = 0; ibin < bins+2; ibin++) {
+          tmp.SetBinContent(ibin, sumw.at(i)[ibin*nweights+k]);
+          tmp.SetBinError(ibin, sqrt(sumw2.at(i)[ibin*nweights+k]));
+        }
+        tmp.SetEntries(entries.at(i));
+        tmp.Write();
+      }
+    }
+  }
+}
+
+void Piece1DMulti::fold_cumulative() {
+  for(int i = (int)sumw.size()-2; i >= 0; i--) {
+    for(size_t j = 0; j < sumw.at(i).size(); j++) {
+      sumw.at(i)[j] += sumw.at(i+1)[j];
+      sumw2.at(i)[j] += sumw2.at(i+1)[j];
+    }
+    entries.at(i) += entries.at(i+1);
+  }
+}
+
+void Piece1DMulti::add_slot() {
+  if(sumw.size() == 0) return;
+  sumw.push_back(std::vector<double>(sumw.front().size(), 0));
+  sumw2.push_back(std::vector<double>(sumw2.front().size(), 0));
+  entries.push_back(0);
+}
+
+void Piece1DMulti::fold_nminus1() {
+  for(size_t i = 0; i+1 < sumw.size(); i++) {
+    for(size_t j = 0; j < sumw.at(i).size(); j++) {
+      sumw.at(i)[j] += sumw.back()[j];
+      sumw2.at(i)[j] += sumw2.back()[j];
+    }
+    entries.at(i) += entries.back();
+  }
+}
+
 /*------------------------------------------------------------------------------------------*/
 
 Piece2D::Piece2D(std::string _name, int _binx, double _beginx, double _endx, int _biny, double _beginy, double _endy, int _Nfold) :
@@ -56,6 +164,24 @@ void Piece2D::write_histogram(std::vector<std::string>& folders, TFile* outfile,
   }
 }
 
+void Piece2D::fold_cumulative() {
+  for(int i = (int)histograms.size()-2; i >= 0; i--) {
+    histograms.at(i).Add(&histograms.at(i+1));
+  }
+}
+
+void Piece2D::add_slot() {
+  if(histograms.size() == 0) return;
+  histograms.push_back(histograms.front());
+  histograms.back().Reset();
+}
+
+void Piece2D::fold_nminus1() {
+  for(size_t i = 0; i+1 < histograms.size(); i++) {
+    histograms.at(i).Add(&histograms.back());
+  }
+}
+
 Piece1DEff::Piece1DEff(std::string _name, int _bins, double _begin, double _end, int _Nfold) :
 DataPiece(_name, _Nfold), begin(_begin), end(_end), bins(_bins) {
   for(int i = 0; i < _Nfold; i++) {
@@ -82,7 +208,7 @@ void Piece1DEff::write_histogram(std::vector<std::string>& folders, TFile* outfi
 
 DataBinner::DataBinner(){}
 
-DataBinner::DataBinner(const DataBinner& rhs) : fillSingle(rhs.fillSingle) {
+DataBinner::DataBinner(const DataBinner& rhs) : fillSingle(rhs.fillSingle), fillCumulative(rhs.fillCumulative), fillNMinusOne(rhs.fillNMinusOne), folded(rhs.folded) {
   std::cout << "copied" << std::endl;
   order = rhs.order;
 
@@ -93,10 +219,15 @@ DataBinner::DataBinner(const DataBinner& rhs) : fillSingle(rhs.fillSingle) {
       datamap[it.first] = new Piece2D(*static_cast<Piece2D*>(it.second));
     }
   }
+  multiorder = rhs.multiorder;
+  multiWeights = rhs.multiWeights;
+  for(auto it: rhs.multimap) {
+    multimap[it.first] = new Piece1DMulti(*it.second);
+  }
 
 }
 
-DataBinner::DataBinner(DataBinner&& rhs) : fillSingle(rhs.fillSingle) {
+DataBinner::DataBinner(DataBinner&& rhs) : fillSingle(rhs.fillSingle), fillCumulative(rhs.fillCumulative), fillNMinusOne(rhs.fillNMinusOne), folded(rhs.folded) {
   std::cout << "moved" << std::endl;
   for(auto it: datamap) {
     if(it.second != nullptr) {
@@ -107,8 +238,12 @@ DataBinner::DataBinner(DataBinner&& rhs) : fillSingle(rhs.fillSingle) {
 
   order = rhs.order;
   datamap.swap(rhs.datamap);
+  multiorder = rhs.multiorder;
+  multiWeights = rhs.multiWeights;
+  multimap.swap(rhs.multimap);
 
   rhs.datamap.clear();
+  rhs.multimap.clear();
 }
 
 
@@ -119,6 +254,7 @@ DataBinner::~DataBinner() {
       it.second = nullptr;
     }
   }
+  for(auto it: multimap) delete it.second;
 }
 
 void DataBinner::Add_Hist(std::string shortname, std::string fullname, int bin, double left, double right, int Nfolder) {
@@ -131,6 +267,15 @@ void DataBinner::Add_Hist(std::string shortname, std::string fullname, int binx,
   order.push_back(shortname);
 }
 
+void DataBinner::Add_MultiHist(std::string shortname, std::string fullname, int bin, double left, double right, int nweights, int Nfolder) {
+  multimap[shortname] = new Piece1DMulti(fullname, bin, left, right, nweights, Nfolder);
+  multiorder.push_back(shortname);
+}
+
+void DataBinner::setMultiAsTH2(bool asTH2) {
+  for(auto it: multimap) it.second->setAsTH2(asTH2);
+}
+
 void DataBinner::Add_Hist(std::string shortname, int bin, double left, double right, int Nfolder) {
   datamap[shortname] = new Piece1DEff(shortname, bin, left, right, Nfolder);
   order.push_back(shortname);
@@ -138,38 +283,93 @@ void DataBinner::Add_Hist(std::string shortname, int bin, double left, double ri
 
 
 void DataBinner::AddPoint(std::string name, int maxfolder, double value, double weight) {
-  if(datamap.count(name) == 0)  return;
+  auto it = datamap.find(name);
+  if(it == datamap.end())  return;
+
+  Piece1DMulti* multi = nullptr;
+  if(multiWeights != nullptr && multimap.size() != 0) {
+    auto mit = multimap.find(name);
+    if(mit != multimap.end()) multi = mit->second;
+  }
 
   if(fillSingle) {
     if(maxfolder < 0) return;
-    datamap.at(name)->bin(maxfolder,value, weight);
+    it->second->bin(maxfolder,value, weight);
+    if(multi != nullptr) multi->bin(maxfolder, value, weight, *multiWeights);
+  } else if(fillCumulative) {
+    if(maxfolder <= 0) return;
+    it->second->bin(maxfolder-1,value, weight);
+    if(multi != nullptr) multi->bin(maxfolder-1, value, weight, *multiWeights);
   } else {
 
     for(int i=0; i < maxfolder; i++) {
-      datamap.at(name)->bin(i,value, weight);
+      it->second->bin(i,value, weight);
+      if(multi != nullptr) multi->bin(i, value, weight, *multiWeights);
     }
   }
 }
 
 void DataBinner::AddPoint(std::string name, int maxfolder, double valuex, double valuey, double weight) {
-  if(datamap.count(name) == 0) return;
+  auto it = datamap.find(name);
+  if(it == datamap.end()) return;
 
   if(fillSingle) {
     if(maxfolder < 0) return;
-    datamap.at(name)->bin(maxfolder,valuex, valuey, weight);
+    it->second->bin(maxfolder,valuex, valuey, weight);
+  } else if(fillCumulative) {
+    if(maxfolder <= 0) return;
+    it->second->bin(maxfolder-1,valuex, valuey, weight);
   } else {
     for(int i=0; i < maxfolder; i++) {
-      datamap.at(name)->bin(i,valuex, valuey, weight);
+      it->second->bin(i,valuex, valuey, weight);
     }
   }
 }
 
-void DataBinner::AddEff(std::string name, int maxfolder, double valuex, bool passFail) {
+void DataBinner::AddPoint(std::string name, const std::vector<int>& folders, const std::vector<double>& scales, double value, double weight) {
+  auto it = datamap.find(name);
+  if(it == datamap.end()) return;
+
+  for(size_t i = 0; i < folders.size(); i++) {
+    it->second->bin(folders[i], value, weight*scales[i]);
+  }
+}
+
+void DataBinner::AddPoint(std::string name, const std::vector<int>& folders, const std::vector<double>& scales, double valuex, double valuey, double weight) {
+  auto it = datamap.find(name);
+  if(it == datamap.end()) return;
+
+  for(size_t i = 0; i < folders.size(); i++) {
+    it->second->bin(folders[i], valuex, valuey, weight*scales[i]);
+  }
+}
+
+void DataBinner::setNMinusOneFill() {
+  fillSingle = true;
+  fillNMinusOne = true;
+  for(auto it: datamap) it.second->add_slot();
+  for(auto it: multimap) it.second->add_slot();
+}
+
+void DataBinner::AddEff(const std::string& name, int maxfolder, double valuex, bool passFail) {
   datamap.at(name)->bin(maxfolder, valuex, passFail);
 }
 
 void DataBinner::write_histogram(TFile* outfile, std::vector<std::string>& folders, std::string subfolder) {
+  ////only fold once, the slots are cumulative afterwards
+  if(fillCumulative && !fillSingle && !folded) {
+    for(auto it: datamap) it.second->fold_cumulative();
+    for(auto it: multimap) it.second->fold_cumulative();
+    folded = true;
+  } else if(fillNMinusOne && !folded) {
+    for(auto it: datamap) it.second->fold_nminus1();
+    for(auto it: multimap) it.second->fold_nminus1();
+    folded = true;
+  }
   for(std::vector<std::string>::iterator it = order.begin(); it != order.end(); it++) {
     datamap.at(*it)->write_histogram(folders, outfile, subfolder);
   }
+  for(auto it: multiorder) {
+    multimap.at(it)->write_histogram(folders, outfile, subfolder);
+  }
 }
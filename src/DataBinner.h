@@ -6,6 +6,8 @@
 #include <unordered_map>
 #include <iostream>
 #include <cassert>
+#include <cmath>
+#include <algorithm>
 #include <TH1.h>
 #include <TH2.h>
 #include <TEfficiency.h>
@@ -33,6 +35,15 @@ input: folder -- folder of histogram that will be incremented
 x (y) -- value of the x axis (and y axis if 2D)
 weight -- weight given to the value.
 
+fold_cumulative()
+Used when the DataBinner fills every value only into the last folder it reached.  Turns
+those per-folder slots into the usual cumulative folders with a reverse running sum
+(folder i = sum of slots j>=i), errors included.
+
+add_slot() / fold_nminus1()
+Used for N-1 folders: one extra slot holds the events passing every cut, it is added to
+all the other folders (events failing only that cut) before writing.
+
 */
 class DataPiece {
 protected:
@@ -49,6 +60,9 @@ public:
   virtual void bin(int, double, double) {};
   virtual void bin(int, double, double, double) {};
   virtual void bin(int, double, bool) {};
+  virtual void fold_cumulative() {};
+  virtual void add_slot() {};
+  virtual void fold_nminus1() {};
 
 };
 
@@ -65,6 +79,9 @@ public:
   Piece1D(std::string, int, double, double, int);
   void write_histogram(std::vector<std::string>&, TFile*, std::string subfolder);
   void bin(int, double, double);
+  void fold_cumulative();
+  void add_slot();
+  void fold_nminus1();
 };
 
 
@@ -79,6 +96,35 @@ public:
   Piece2D(std::string, int, double, double, int, double, double, int);
   void write_histogram(std::vector<std::string>&, TFile*, std::string subfolder);
   void bin(int, double, double, double);
+  void fold_cumulative();
+  void add_slot();
+  void fold_nminus1();
+};
+
+
+/*
+Piece1DMulti: 1D histogram with K weights per fill (PDF/scale replicas).  The sums are kept
+bin-major, entry (bin, k) at bin*K+k, so one fill finds the bin once and adds the K weights
+next to each other.  Written as K TH1Ds (<name>_w<k>) or as one TH2D (<name>_weights) with
+the weight index on the y axis.
+*/
+class Piece1DMulti : public DataPiece {
+private:
+  const double begin, end;
+  const int bins, nweights;
+  bool asTH2 = false;
+
+  std::vector<std::vector<double> > sumw, sumw2;
+  std::vector<double> entries;
+
+public:
+  Piece1DMulti(std::string, int, double, double, int, int);
+  void write_histogram(std::vector<std::string>&, TFile*, std::string subfolder);
+  void bin(int, double, double, const std::vector<double>&);
+  void fold_cumulative();
+  void add_slot();
+  void fold_nminus1();
+  void setAsTH2(bool _asTH2) {asTH2 = _asTH2;}
 };
 
 
@@ -120,6 +166,23 @@ public:
                 right   -- The upper limit of the histogram
                Nfolder  -- The number of folders in the outfile.  Used for writing same histogram (eg MET) to different
 	                   folders with different cuts
+
+  setCumulativeFill()
+       Instead of filling a value into every folder below maxfolder, fill it once into the slot of
+       the last folder the event reached (maxfolder-1).  The cumulative folders are rebuilt in
+       write_histogram, so the output is the same but each fill costs one histogram lookup.
+
+  setNMinusOneFill()
+       Folders are N-1 folders: maxfolder is the one cut the event failed, or the number of
+       folders if it passed all of them.  Those events are added to every folder on write.
+
+  AddPoint(std::string shortname, std::vector<int> folders, std::vector<double> scales, value(s), weight)
+       Weight columns: fills the same value into each of the folders with weight*scales[i], one
+       histogram lookup for all of them.  Used for the weight-only systematics.
+  Add_MultiHist(std::string shortname, std::string fullname, int bin, double left, double right, int nweights, int Nfolder)
+       Adds K=nweights weight variations of the (already added) histogram shortname.  They are
+       filled by AddPoint together with it, with weight*w[k], as long as setMultiWeights was given
+       the vector of per event weights w.
  */
 class DataBinner {
 public:
@@ -132,17 +195,31 @@ public:
 
   void AddPoint(std::string,int, double, double);
   void AddPoint(std::string,int, double, double, double);
+  void AddPoint(std::string, const std::vector<int>&, const std::vector<double>&, double, double);
+  void AddPoint(std::string, const std::vector<int>&, const std::vector<double>&, double, double, double);
   void Add_Hist(std::string, std::string, int, double, double, int);
   void Add_Hist(std::string, std::string, int, double, double, int, double, double, int);
   void Add_Hist(std::string, int, double, double, int);
-  void AddEff(std::string, int, double, bool);
+  void Add_MultiHist(std::string, std::string, int, double, double, int, int);
+  void AddEff(const std::string&, int, double, bool);
+  bool has(const std::string& name) const {return datamap.find(name) != datamap.end();}
   void write_histogram(TFile*, std::vector<std::string>&, std::string);
   void setSingleFill() {fillSingle = true;}
+  void setCumulativeFill() {fillCumulative = true;}
+  void setNMinusOneFill();
+  void setMultiWeights(const std::vector<double>* weights) {multiWeights = weights;}
+  void setMultiAsTH2(bool);
 
 private:
   std::unordered_map<std::string, DataPiece*> datamap;
   std::vector<std::string> order;
+  std::unordered_map<std::string, Piece1DMulti*> multimap;
+  std::vector<std::string> multiorder;
+  const std::vector<double>* multiWeights = nullptr;
   bool fillSingle = false;
+  bool fillCumulative = false;
+  bool fillNMinusOne = false;
+  bool folded = false;
 };
 
 #endif
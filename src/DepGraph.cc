@@ -112,3 +112,13 @@ bool DepGraph::isPresent(CUTS cut) {
 std::unordered_set<int> DepGraph::getCuts() {
   return neededCuts;
 }
+
+////(cut, cut it depends on) for every edge
+std::vector<std::pair<CUTS, CUTS> > DepGraph::getDependencies() {
+  std::vector<std::pair<CUTS, CUTS> > dependencies;
+  boost::graph_traits<mygraph>::edge_iterator it, end;
+  for(tie(it, end) = edges(g); it != end; ++it) {
+    dependencies.push_back(std::make_pair(intcut(source(*it, g)), intcut(target(*it, g))));
+  }
+  return dependencies;
+}
@@ -19,6 +19,7 @@ public:
   void loadCuts(CUTS);
   bool isPresent(CUTS);
   std::unordered_set<int> getCuts();
+  std::vector<std::pair<CUTS, CUTS> > getDependencies();
   
 private:
   void dfs(int vertex);
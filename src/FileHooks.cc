@@ -0,0 +1,41 @@
+#include "FileHooks.h"
+#include <unordered_map>
+#include <algorithm>
+
+static std::unordered_map<TTree*, std::unique_ptr<FileHooks> >& allHooks() {
+  static std::unordered_map<TTree*, std::unique_ptr<FileHooks> > hooks;
+  return hooks;
+}
+
+FileHooks& FileHooks::get(TTree* tree) {
+  auto found = allHooks().find(tree);
+  if(found == allHooks().end()) {
+    found = allHooks().emplace(tree, std::unique_ptr<FileHooks>(new FileHooks(tree))).first;
+    tree->SetNotify(found->second.get());
+  }
+  return *found->second;
+}
+
+void FileHooks::release(TTree* tree) {
+  auto found = allHooks().find(tree);
+  if(found == allHooks().end()) return;
+  tree->SetNotify(nullptr);
+  allHooks().erase(found);
+}
+
+void FileHooks::add(const void* owner, std::function<void(TTree*)> hook) {
+  hooks.push_back(std::make_pair(owner, hook));
+  if(tree->GetTree() != nullptr) hook(tree->GetTree());
+}
+
+void FileHooks::remove(const void* owner) {
+  hooks.erase(std::remove_if(hooks.begin(), hooks.end(), [owner](const std::pair<const void*, std::function<void(TTree*)> >& hook) {
+        return hook.first == owner;
+      }), hooks.end());
+}
+
+Bool_t FileHooks::Notify() {
+  nfiles++;
+  for(auto& hook: hooks) hook.second(tree->GetTree());
+  return true;
+}
@@ -0,0 +1,46 @@
+#ifndef FILE_HOOKS_H_
+#define FILE_HOOKS_H_
+
+#include <TObject.h>
+#include <TTree.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/*
+FileHooks: functions called every time a chain moves on to a new file.
+
+It is the notify object of the tree (TTree::SetNotify), ROOT calls it from LoadTree when the
+file changes, so nothing is checked per event.  One per tree, shared by every Analyzer
+running over it.  The hooks get the tree of the new file; they run in the middle of
+LoadTree and must not read entries themselves, only note what has to be redone.
+
+add(owner, hook)
+  Calls hook(tree of the file) on every new file, and once now if a file is already loaded.
+
+remove(owner)
+  Forgets the hooks of owner.
+
+release(TTree*)
+  Forgets the hooks of a tree, called when the tree is deleted.
+*/
+class FileHooks : public TObject {
+public:
+  static FileHooks& get(TTree*);
+  static void release(TTree*);
+
+  void add(const void* owner, std::function<void(TTree*)> hook);
+  void remove(const void* owner);
+  int files() const {return nfiles;}
+
+  Bool_t Notify();
+
+private:
+  FileHooks(TTree* _tree) : tree(_tree) {}
+
+  TTree* tree;
+  int nfiles = 0;
+  std::vector<std::pair<const void*, std::function<void(TTree*)> > > hooks;
+};
+
+#endif
@@ -16,6 +16,7 @@ outfile(nullptr), Npdf(_Npdf), isData(_isData) {
   }
   
   NFolders = folders.size();
+  fill_cut_lookup();
   read_hist(histname);
 
   if(folderCuts.size() != 0 || syst_unvertainties.size() != 0) {
@@ -30,12 +31,18 @@ Histogramer& Histogramer::operator=(const Histogramer& rhs) {
 
   outname = rhs.outname;
   NFolders = rhs.NFolders;
+  Npdf = rhs.Npdf;
   isData = rhs.isData;
 
   cuts = rhs.cuts;
   cut_order = rhs.cut_order;
   folders = rhs.folders;
   folderToCutNum = rhs.folderToCutNum;
+  cutToFolder = rhs.cutToFolder;
+  cutCorr = rhs.cutCorr;
+  cutCorrW2 = rhs.cutCorrW2;
+  columnFolders = rhs.columnFolders;
+  columnScales = rhs.columnScales;
   data_order.reserve(rhs.data_order.size());
   data_order = rhs.data_order;
   fillSingle = rhs.fillSingle;
@@ -55,6 +62,7 @@ Histogramer& Histogramer::operator=(Histogramer&& rhs) {
 
   outname = rhs.outname;
   NFolders = rhs.NFolders;
+  Npdf = rhs.Npdf;
   isData = rhs.isData;
   outfile = rhs.outfile;
 
@@ -62,6 +70,11 @@ Histogramer& Histogramer::operator=(Histogramer&& rhs) {
   cut_order = rhs.cut_order;
   folders = rhs.folders;
   folderToCutNum = rhs.folderToCutNum;
+  cutToFolder = rhs.cutToFolder;
+  cutCorr = rhs.cutCorr;
+  cutCorrW2 = rhs.cutCorrW2;
+  columnFolders = rhs.columnFolders;
+  columnScales = rhs.columnScales;
 
   data_order = rhs.data_order;
   fillSingle = rhs.fillSingle;
@@ -75,12 +88,17 @@ Histogramer& Histogramer::operator=(Histogramer&& rhs) {
 
 
 Histogramer::Histogramer(const Histogramer& rhs) :
-outname(rhs.outname), NFolders(rhs.NFolders), isData(rhs.isData), fillSingle(rhs.fillSingle)
+outname(rhs.outname), NFolders(rhs.NFolders), Npdf(rhs.Npdf), isData(rhs.isData), fillSingle(rhs.fillSingle)
 {
   cuts = rhs.cuts;
   cut_order = rhs.cut_order;
   folders = rhs.folders;
   folderToCutNum = rhs.folderToCutNum;
+  cutToFolder = rhs.cutToFolder;
+  cutCorr = rhs.cutCorr;
+  cutCorrW2 = rhs.cutCorrW2;
+  columnFolders = rhs.columnFolders;
+  columnScales = rhs.columnScales;
   data_order = rhs.data_order;
 
   for(auto mit: rhs.data) {
@@ -93,12 +111,17 @@ outname(rhs.outname), NFolders(rhs.NFolders), isData(rhs.isData), fillSingle(rhs
 }
 
 Histogramer::Histogramer(Histogramer&& rhs) :
-outname(rhs.outname), NFolders(rhs.NFolders), isData(rhs.isData), fillSingle(rhs.fillSingle)
+outname(rhs.outname), NFolders(rhs.NFolders), Npdf(rhs.Npdf), isData(rhs.isData), fillSingle(rhs.fillSingle)
 {
   cuts = rhs.cuts;
   cut_order = rhs.cut_order;
   folders = rhs.folders;
   folderToCutNum = rhs.folderToCutNum;
+  cutToFolder = rhs.cutToFolder;
+  cutCorr = rhs.cutCorr;
+  cutCorrW2 = rhs.cutCorrW2;
+  columnFolders = rhs.columnFolders;
+  columnScales = rhs.columnScales;
   data_order = rhs.data_order;
   data.swap(rhs.data);
   outfile = rhs.outfile;
@@ -148,6 +171,11 @@ void Histogramer::read_hist(std::string filename) {
     else if(stemp.size() == 4) {
       std::string name = extractHistname(group, stemp[0]);
       data[group]->Add_Hist(name, stemp[0], stod(stemp[1]), stod(stemp[2]), stod(stemp[3]), NFolders);
+    } else if(stemp.size() == 5 && stemp[4] == "weights") {
+      ////also keep the Npdf weight variations of this histogram
+      std::string name = extractHistname(group, stemp[0]);
+      data[group]->Add_Hist(name, stemp[0], stod(stemp[1]), stod(stemp[2]), stod(stemp[3]), NFolders);
+      if(Npdf > 1) data[group]->Add_MultiHist(name, stemp[0], stod(stemp[1]), stod(stemp[2]), stod(stemp[3]), Npdf, NFolders);
     } else if(stemp.size() == 7) {
       std::string name = extractHistname(group, stemp[0]);
       data[group]->Add_Hist(name, stemp[0], stod(stemp[1]), stod(stemp[2]), stod(stemp[3]),stod(stemp[4]), stod(stemp[5]), stod(stemp[6]), NFolders);
@@ -301,6 +329,18 @@ void Histogramer::fill_histogram(std::string subfolder) {
   for (std::unordered_map<std::string, TTree * >::iterator it = trees.begin(); it != trees.end(); ++it) {
     it->second->Write();
   }
+  if(cutCorr.size() != 0) {
+    TH2D corr("CutCorrelation", "CutCorrelation", NFolders, 0, NFolders, NFolders, 0, NFolders);
+    for(int i = 0; i < NFolders; i++) {
+      corr.GetXaxis()->SetBinLabel(i+1, folders.at(i).c_str());
+      corr.GetYaxis()->SetBinLabel(i+1, folders.at(i).c_str());
+      for(int j = 0; j < NFolders; j++) {
+        corr.SetBinContent(i+1, j+1, cutCorr[i*NFolders+j]);
+        corr.SetBinError(i+1, j+1, sqrt(cutCorrW2[i*NFolders+j]));
+      }
+    }
+    corr.Write();
+  }
   outfile->Close();
 }
 
@@ -316,37 +356,90 @@ void Histogramer::fillTree(std::string name) {
 }
 
 
-void Histogramer::addVal(double valuex, double valuey, std::string group, int maxcut, std::string histn, double weight) {
-  int maxFolder=0;
-
-
-  if(fillSingle) maxFolder = maxcut;
-  else {
+////number of folders passed by an event that made it through maxcut cuts
+void Histogramer::fill_cut_lookup() {
+  int ncuts = folderToCutNum.size() == 0 ? 0 : folderToCutNum.back()+1;
+  ncuts = std::max(ncuts, (int)cut_order.size());
+  cutToFolder.assign(ncuts+1, 0);
+  for(int maxcut = 0; maxcut <= ncuts; maxcut++) {
+    int maxFolder = 0;
     for(int i = 0; i < NFolders; i++) {
       if(maxcut > folderToCutNum[i]) maxFolder++;
       else break;
     }
+    cutToFolder[maxcut] = maxFolder;
   }
-  data[group]->AddPoint(histn, maxFolder, valuex, valuey, weight);
 }
 
-void Histogramer::addVal(double value, std::string group, int maxcut, std::string histn, double weight) {
-  int maxFolder=0;
+int Histogramer::get_folder(int maxcut) const {
+  if(fillSingle) return maxcut;
+  if(maxcut <= 0) return 0;
+  if(maxcut >= (int)cutToFolder.size()) return NFolders;
+  return cutToFolder[maxcut];
+}
 
+void Histogramer::setCumulativeFill() {
+  if(fillSingle) return;
+  for(auto it: data) it.second->setCumulativeFill();
+}
 
-  if(fillSingle) maxFolder = maxcut;
-  else {
-    for(int i = 0; i < NFolders; i++) {
-      if(maxcut > folderToCutNum[i]) maxFolder++;
-      else break;
+////folders are the cuts, the histograms of events passing everything are added to each of them when written
+void Histogramer::setNMinusOneFill() {
+  for(auto it: data) it.second->setNMinusOneFill();
+  cutCorr.assign(NFolders*NFolders, 0);
+  cutCorrW2.assign(NFolders*NFolders, 0);
+}
+
+////bit i of the mask is set if cut i passed, (i,j) sums the weight of events passing both
+void Histogramer::addCutMask(uint64_t mask, double weight) {
+  for(int i = 0; i < NFolders; i++) {
+    if(!(mask & (1ULL << i))) continue;
+    for(int j = 0; j < NFolders; j++) {
+      if(!(mask & (1ULL << j))) continue;
+      cutCorr[i*NFolders+j] += weight;
+      cutCorrW2[i*NFolders+j] += weight*weight;
     }
   }
-  data[group]->AddPoint(histn, maxFolder, value, weight);
+}
+
+////per event weights for the histograms with weight variations (Npdf of them are used)
+void Histogramer::setMultiWeights(const std::vector<double>* weights) {
+  for(auto it: data) it.second->setMultiWeights(weights);
+}
+
+void Histogramer::setMultiWeightsAsTH2(bool asTH2) {
+  for(auto it: data) it.second->setMultiAsTH2(asTH2);
+}
+
+void Histogramer::setWeightColumns(const std::vector<int>& folderNums) {
+  columnFolders = folderNums;
+  columnScales.assign(folderNums.size(), 1.);
+}
+
+////until endWeightColumns, every addVal goes into all the column folders (maxcut is ignored)
+void Histogramer::beginWeightColumns(const std::vector<double>& scales) {
+  columnScales = scales;
+  fillColumns = true;
+}
+
+void Histogramer::addVal(double valuex, double valuey, std::string group, int maxcut, std::string histn, double weight) {
+  if(fillColumns) data[group]->AddPoint(histn, columnFolders, columnScales, valuex, valuey, weight);
+  else data[group]->AddPoint(histn, get_folder(maxcut), valuex, valuey, weight);
+}
+
+void Histogramer::addVal(double value, std::string group, int maxcut, std::string histn, double weight) {
+  if(fillColumns) data[group]->AddPoint(histn, columnFolders, columnScales, value, weight);
+  else data[group]->AddPoint(histn, get_folder(maxcut), value, weight);
 }
 
 
 
-void Histogramer::addEffiency(std::string histn ,double value ,bool passFail,int maxFolder=0){
+bool Histogramer::hasHist(const std::string& group, const std::string& histn) const {
+  auto it = data.find(group);
+  return it != data.end() && it->second->has(histn);
+}
+
+void Histogramer::addEffiency(const std::string& histn ,double value ,bool passFail,int maxFolder=0){
   
   data["Eff"]->AddEff(histn, maxFolder, value,passFail);
 }
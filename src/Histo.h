@@ -43,8 +43,17 @@ public:
 
   void addVal(double, std::string, int, std::string, double);
   void addVal(double, double, std::string, int, std::string, double);
-  void addEffiency(std::string,double,bool,int);
+  void addEffiency(const std::string&,double,bool,int);
+  bool hasHist(const std::string& group, const std::string& histn) const;
   void fill_histogram(std::string subfolder="");
+  void setCumulativeFill();
+  void setNMinusOneFill();
+  void addCutMask(uint64_t, double);
+  void setMultiWeights(const std::vector<double>*);
+  void setMultiWeightsAsTH2(bool);
+  void setWeightColumns(const std::vector<int>&);
+  void beginWeightColumns(const std::vector<double>&);
+  void endWeightColumns() {fillColumns = false;}
   void setControlRegions();
   void createTree(std::unordered_map< std::string , float >*, std::string);
   void fillTree(std::string);
@@ -63,6 +72,12 @@ private:
 
   std::vector<std::string> folders;
   std::vector<int> folderToCutNum;
+  std::vector<int> cutToFolder;
+  std::vector<double> cutCorr, cutCorrW2;
+  ////folders filled together from the nominal selection, weight scaled per folder
+  std::vector<int> columnFolders;
+  std::vector<double> columnScales;
+  bool fillColumns = false;
 
   std::unordered_map<std::string, DataBinner*> data;
   std::vector<std::string> data_order;
@@ -72,6 +87,8 @@ private:
   void read_cuts(std::string filename, std::vector<std::string>&);
   void read_syst(const std::vector<std::string>& syst_uncertainties);
   void fillCRFolderNames(std::string, int, bool, const std::vector<std::string>&);
+  void fill_cut_lookup();
+  int get_folder(int) const;
 
   std::string extractHistname(std::string, std::string) const;
 };
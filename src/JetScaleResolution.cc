@@ -202,6 +202,132 @@ double JetScaleResolution::GetScale(const TLorentzVector& jet, bool isBjet, doub
     }
 }
 
+//the 27 uncorrelated sources, the SubTotal/Total/Flavor*/TimeRun*/CorrelationGroup sections are combinations or alternatives
+const std::vector<std::string> JetScaleResolution::defaultSources = {
+    "AbsoluteStat", "AbsoluteScale", "AbsoluteFlavMap", "AbsoluteMPFBias", "Fragmentation", "SinglePionECAL",
+    "SinglePionHCAL", "FlavorQCD", "TimePtEta", "RelativeJEREC1", "RelativeJEREC2", "RelativeJERHF",
+    "RelativePtBB", "RelativePtEC1", "RelativePtEC2", "RelativePtHF", "RelativeBal", "RelativeFSR",
+    "RelativeStatFSR", "RelativeStatEC", "RelativeStatHF", "PileUpDataMC", "PileUpPtRef", "PileUpPtBB",
+    "PileUpPtEC1", "PileUpPtEC2", "PileUpPtHF"
+};
+
+void JetScaleResolution::InitSources(const std::string& filename, const std::vector<std::string>& sources)
+{
+    std::fstream fs(filename.c_str(), std::fstream::in);
+    if(!fs.good()){
+        std::cout<<"Jet file "<<filename<<" does not exist!"<<std::endl;
+        exit(2);
+    }
+    //rows of each wanted section: etamin etamax npoints (pt errm errp)...
+    std::map<std::string, std::vector<std::vector<double> > > rows;
+    std::string line, section;
+    while(getline(fs, line))
+    {
+        trim(line);
+        if(line.size() == 0 || line[0] == '#' || line[0] == '{') continue;
+        if(line[0] == '[')
+        {
+            section = line.substr(1, line.find(']')-1);
+            continue;
+        }
+        if(std::find(sources.begin(), sources.end(), section) == sources.end()) continue;
+        std::vector<std::string> vals = string_split(line, {" ", "\t"});
+        std::vector<double> row;
+        for(auto& val: vals) row.push_back(stringtotype<double>(val));
+        rows[section].push_back(row);
+    }
+    fs.close();
+
+    sourceNames = sources;
+    int nsrc = sources.size();
+    const std::vector<std::vector<double> >* grid = nullptr;
+    for(auto& source: sources)
+    {
+        if(rows.find(source) == rows.end())
+        {
+            std::cout << "ERROR - JetScaleResolution.InitSources: no source " << source << " in " << filename << std::endl;
+            exit(2);
+        }
+        const std::vector<std::vector<double> >& srows = rows.at(source);
+        if(grid == nullptr) grid = &srows;
+        bool same = srows.size() == grid->size();
+        for(size_t e = 0; same && e < srows.size(); e++)
+        {
+            same = srows[e].size() == grid->at(e).size() && srows[e][0] == grid->at(e)[0] && srows[e][1] == grid->at(e)[1];
+            for(size_t p = 3; same && p < srows[e].size(); p+=3) same = srows[e][p] == grid->at(e)[p];
+        }
+        if(!same)
+        {
+            std::cout << "ERROR - JetScaleResolution.InitSources: " << source << " does not use the same (eta, pt) bins as " << sources.front() << std::endl;
+            exit(2);
+        }
+    }
+    if(grid == nullptr || grid->size() == 0) return;
+
+    for(auto& row: *grid)
+    {
+        if(srcEtaEdges.size() == 0) srcEtaEdges.push_back(row[0]);
+        srcEtaEdges.push_back(row[1]);
+        srcPtOffset.push_back(srcPt.size());
+        for(size_t p = 3; p+2 < row.size(); p+=3) srcPt.push_back(row[p]);
+    }
+    srcPtOffset.push_back(srcPt.size());
+
+    srcUp.assign(srcPt.size()*nsrc, 0);
+    srcDown.assign(srcPt.size()*nsrc, 0);
+    for(int s = 0; s < nsrc; s++)
+    {
+        const std::vector<std::vector<double> >& srows = rows.at(sources[s]);
+        for(size_t e = 0; e < srows.size(); e++)
+        {
+            int point = srcPtOffset[e];
+            for(size_t p = 3; p+2 < srows[e].size(); p+=3, point++)
+            {
+                srcDown[point*nsrc+s] = srows[e][p+1];
+                srcUp[point*nsrc+s] = srows[e][p+2];
+            }
+        }
+    }
+    std::cout << "Read " << nsrc << " jet energy scale sources from " << filename << std::endl;
+}
+
+//linear in pt between the grid points (constant outside), no shift outside the eta range
+void JetScaleResolution::GetSourceShifts(Span<double> eta, Span<double> pt, std::vector<double>& up, std::vector<double>& down) const
+{
+    int nsrc = sourceNames.size();
+    up.assign(eta.size()*nsrc, 0);
+    down.assign(eta.size()*nsrc, 0);
+    if(srcEtaEdges.size() < 2) return;
+
+    for(size_t j = 0; j < eta.size(); j++)
+    {
+        if(eta[j] < srcEtaEdges.front() || eta[j] >= srcEtaEdges.back()) continue;
+        int e = std::upper_bound(srcEtaEdges.begin(), srcEtaEdges.end(), eta[j]) - srcEtaEdges.begin() - 1;
+        const double* ptBegin = srcPt.data() + srcPtOffset[e];
+        const double* ptEnd = srcPt.data() + srcPtOffset[e+1];
+        if(ptBegin == ptEnd) continue;
+
+        int hi = std::upper_bound(ptBegin, ptEnd, pt[j]) - ptBegin;
+        int lo = hi - 1;
+        double frac = 0;
+        if(hi == 0) lo = 0;
+        else if(hi == ptEnd - ptBegin) hi = lo;
+        else frac = (pt[j] - ptBegin[lo]) / (ptBegin[hi] - ptBegin[lo]);
+
+        const double* upLo = &srcUp[(srcPtOffset[e]+lo)*nsrc];
+        const double* upHi = &srcUp[(srcPtOffset[e]+hi)*nsrc];
+        const double* downLo = &srcDown[(srcPtOffset[e]+lo)*nsrc];
+        const double* downHi = &srcDown[(srcPtOffset[e]+hi)*nsrc];
+        double* jetUp = &up[j*nsrc];
+        double* jetDown = &down[j*nsrc];
+        for(int s = 0; s < nsrc; s++)
+        {
+            jetUp[s] = upLo[s] + frac*(upHi[s] - upLo[s]);
+            jetDown[s] = downLo[s] + frac*(downHi[s] - downLo[s]);
+        }
+    }
+}
+
 std::vector<std::string> string_split(const std::string& in, const std::vector<std::string> splits)
 {
     std::vector<std::pair<size_t, size_t> > positions;
@@ -13,6 +13,7 @@
 #include <fstream>
 #include <cmath>
 #include <algorithm>
+#include "Span.h"
 //#include "Particle.h"
 
 //using namespace std;
@@ -96,6 +97,14 @@ class JetScaleResolution{
         double GetRes(const TLorentzVector& jet,const TLorentzVector& genjet, double rho, double sigmares);
         double GetScale(const TLorentzVector& jet, bool isBjet, double sigmascale);
 
+        //per source JES uncertainties ([Source] sections of the UncertaintySources file)
+        //all sources share the (eta, pt) grid and are stored next to each other for each grid point,
+        //GetSourceShifts gives up[j*N+s], down[j*N+s] for every jet j and source s in one pass
+        void InitSources(const std::string& filename, const std::vector<std::string>& sources);
+        void GetSourceShifts(Span<double> eta, Span<double> pt, std::vector<double>& up, std::vector<double>& down) const;
+        const std::vector<std::string>& GetSourceNames() const {return sourceNames;}
+        static const std::vector<std::string> defaultSources;
+
     private:
         TH1D* Heta = nullptr;
         std::vector<TH1D*> HptsP;
@@ -111,6 +120,13 @@ class JetScaleResolution{
 
         std::map< Bin, std::map<Bin, std::vector<double> > > resinfo;
         std::map< Bin, std::vector<double> > ressf;
+
+        std::vector<std::string> sourceNames;
+        std::vector<double> srcEtaEdges;
+        std::vector<int> srcPtOffset;
+        std::vector<double> srcPt;
+        std::vector<double> srcUp;
+        std::vector<double> srcDown;
 };
 
 #endif /*JETSCALERESOLUTION*/
@@ -0,0 +1,119 @@
+#ifndef Kinematics_h
+#define Kinematics_h
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+/*
+kin: kinematics on plain numbers, for single pairs and for arrays of particles.
+
+The array functions (deltaR2 of all pairs, withinDeltaR) take the components as separate
+arrays (eta[], phi[], ...) and are straight loops without branches in the body, so the
+compiler can vectorise them (-O3 in the Makefile, add -march=native for AVX2/AVX-512).
+They use the same formulas as the scalar functions.
+
+normPhi(dphi)
+  Angle in (-pi, pi], same as the old loop version for any input.
+
+deltaR2(eta1, phi1, eta2, phi2)
+deltaR2(n1, eta1, phi1, n2, eta2, phi2, out)
+  Delta R squared, the array version fills out[i*n2 + j] for all pairs.
+
+withinDeltaR(n, eta, phi, eta0, phi0, dr)
+  True if one of the n particles is closer than dr to (eta0, phi0).
+
+transverseMass(px, py, et, metx, mety, met)
+  mT of an object with the MET, -1 if mT^2 < 0.
+
+collinearFractions(p1x, p1y, p2x, p2y, metx, mety, x1, x2)
+  Fractions of the collinear approximation, true if both are negative (the mass can be made
+  with momenta scaled by 1+x1, 1+x2).
+
+pZeta(p1x, p1y, phi1, p2x, p2y, phi2, metx, mety, pzeta, pzetaVis)
+  Projections on the bisector of the two visible directions.
+*/
+namespace kin {
+  const double PI = 3.14159265358979323846;
+  const double TWO_PI = 2*PI;
+
+  ////how the mass of a pair is made (HowCalculateMassReco)
+  enum class MassMethod {Invariant, Collinear, VectorSumWithMet, Visible};
+
+  inline MassMethod massMethod(const std::string& howCalc) {
+    if(howCalc == "InvariantMass") return MassMethod::Invariant;
+    if(howCalc == "CollinearApprox") return MassMethod::Collinear;
+    if(howCalc == "VectorSumOfVisProductsAndMet") return MassMethod::VectorSumWithMet;
+    return MassMethod::Visible;
+  }
+
+  inline double normPhi(double dphi) {
+    return dphi + TWO_PI*std::floor((PI - dphi)/TWO_PI);
+  }
+
+  inline double deltaR2(double eta1, double phi1, double eta2, double phi2) {
+    double deta = eta1 - eta2;
+    double dphi = normPhi(phi1 - phi2);
+    return deta*deta + dphi*dphi;
+  }
+
+  template <typename T>
+  inline void deltaR2(size_t n1, const T* eta1, const T* phi1, size_t n2, const T* eta2, const T* phi2, T* out) {
+    for(size_t i = 0; i < n1; i++) {
+      T* row = out + i*n2;
+      for(size_t j = 0; j < n2; j++) {
+        T deta = eta1[i] - eta2[j];
+        T dphi = phi1[i] - phi2[j];
+        dphi += T(TWO_PI)*std::floor((T(PI) - dphi)/T(TWO_PI));
+        row[j] = deta*deta + dphi*dphi;
+      }
+    }
+  }
+
+  template <typename T>
+  inline bool withinDeltaR(size_t n, const T* eta, const T* phi, T eta0, T phi0, T dr) {
+    T dr2 = dr*dr;
+    bool found = false;
+    for(size_t i = 0; i < n; i++) {
+      T deta = eta[i] - eta0;
+      T dphi = phi[i] - phi0;
+      dphi += T(TWO_PI)*std::floor((T(PI) - dphi)/T(TWO_PI));
+      found |= (deta*deta + dphi*dphi < dr2);
+    }
+    return found;
+  }
+
+  inline double transverseMass(double px, double py, double et, double metx, double mety, double met) {
+    double sumx = px + metx;
+    double sumy = py + mety;
+    double sumet = et + met;
+    double mt2 = sumet*sumet - (sumx*sumx + sumy*sumy);
+    return (mt2 >= 0) ? std::sqrt(mt2) : -1;
+  }
+
+  inline double mass(double e, double px, double py, double pz) {
+    double m2 = e*e - (px*px + py*py + pz*pz);
+    return (m2 < 0) ? -std::sqrt(-m2) : std::sqrt(m2);
+  }
+
+  inline bool collinearFractions(double p1x, double p1y, double p2x, double p2y, double metx, double mety, double& x1, double& x2) {
+    double denominator = p1x*p2y - p2x*p1y;
+    x1 = (p2y*metx - p2x*mety)/denominator;
+    x2 = (p1x*mety - p1y*metx)/denominator;
+    return x1 < 0. && x2 < 0.;
+  }
+
+  inline void pZeta(double p1x, double p1y, double phi1, double p2x, double p2y, double phi2,
+                    double metx, double mety, double& pzeta, double& pzetaVis) {
+    double zetaX = std::cos(phi1) + std::cos(phi2);
+    double zetaY = std::sin(phi1) + std::sin(phi2);
+    double zetaR = std::sqrt(zetaX*zetaX + zetaY*zetaY);
+    if(zetaR > 0.) { zetaX /= zetaR; zetaY /= zetaR; }
+    double visPx = p1x + p2x;
+    double visPy = p1y + p2y;
+    pzeta = (visPx + metx)*zetaX + (visPy + mety)*zetaY;
+    pzetaVis = visPx*zetaX + visPy*zetaY;
+  }
+}
+
+#endif
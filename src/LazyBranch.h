@@ -0,0 +1,41 @@
+#ifndef LAZY_BRANCH_H_
+#define LAZY_BRANCH_H_
+
+#include <TTree.h>
+#include <string>
+#include "BranchRegistry.h"
+
+/*
+LazyBranch: branch that is only read from the file when it is used.
+
+Used like the pointer of SetBranch (tau.decayMode->at(i)), but the branch is not read by
+GetEntry: the first access in an event reads it for the entry the tree is at, the later
+ones use that.  Meant for the branches only some cuts or fills look at, events that are
+rejected before never decompress them.
+
+bind(tree, name)
+  Sets the branch up, reading nothing yet.  A branch that is not in the tree reads as a
+  null pointer, the same as an unset SetBranch.
+*/
+template <typename T>
+class LazyBranch {
+public:
+  void bind(TTree* tree, const std::string& name) {
+    registry = &BranchRegistry::get(tree);
+    slot = &registry->bindLazy<T>(name);
+  }
+  bool isBound() const {return slot != nullptr;}
+
+  const T* get() const {
+    registry->load(*slot);
+    return slot->value;
+  }
+  const T* operator->() const {return get();}
+  const T& operator*() const {return *get();}
+
+private:
+  BranchRegistry* registry = nullptr;
+  BranchRegistry::TypedSlot<T>* slot = nullptr;
+};
+
+#endif
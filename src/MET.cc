@@ -1,10 +1,10 @@
 #include "MET.h"
 #include <algorithm>
 
-#define SetBranch(name, variable) BOOM->SetBranchStatus(name, true);  BOOM->SetBranchAddress(name, &variable);
+#define SetBranch(name, variable) BranchRegistry::get(BOOM).bind(name, variable);
 
 //particle is a objet that stores multiple versions of the particle candidates
-Met::Met(TTree* _BOOM, std::string _GenName,  std::vector<std::string> _syst_names, double _MT2mass) : BOOM(_BOOM), GenName(_GenName), syst_names(_syst_names), MT2mass(_MT2mass)  {
+Met::Met(TTree* _BOOM, std::string _GenName, const SystRegistry& systs, double _MT2mass) : BOOM(_BOOM), GenName(_GenName), syst_names(systs.names()), MT2mass(_MT2mass)  {
 
   SetBranch((GenName+"_px").c_str(), mMet[0]);
   SetBranch((GenName+"_py").c_str(), mMet[1]);
@@ -17,30 +17,24 @@ Met::Met(TTree* _BOOM, std::string _GenName,  std::vector<std::string> _syst_nam
   syst_MHTphi.resize(syst_names.size());
   
 
-  for( auto name : syst_names) {
-    if(name == "orig") 
+  for(size_t i = 0; i < systs.size(); i++) {
+    if(systs.at(i).shiftsMet)
       systVec.push_back(new TLorentzVector);
-    else if(name.find("Met")!=std::string::npos){
-      systVec.push_back(new TLorentzVector);
-    }
-    else if(name.find("weight")!=std::string::npos){
+    else
       systVec.push_back(nullptr);
-    }else if(name.find("Tau_qcd")!=std::string::npos){
-      systVec.push_back(nullptr);
-    }else
-      systVec.push_back(new TLorentzVector);
   }
   
 
-  if( std::find(syst_names.begin(), syst_names.end(), "MetUncl_Up") != syst_names.end() && _BOOM->GetListOfBranches()->FindObject((GenName+"_UnclEnshiftedPtUp").c_str()) !=0){
+  int up = systs.find(SystKind::Unclustered, 1), down = systs.find(SystKind::Unclustered, -1);
+  if( up != -1 && _BOOM->GetListOfBranches()->FindObject((GenName+"_UnclEnshiftedPtUp").c_str()) !=0){
     SetBranch((GenName+"_UnclEnshiftedPtUp").c_str(), MetUnclUp[0]);
     SetBranch((GenName+"_UnclEnshiftedPhiUp").c_str(), MetUnclUp[1]);
-    Unclup = std::find(syst_names.begin(), syst_names.end(), "MetUncl_Up") -syst_names.begin();
+    Unclup = up;
   }
-  if( std::find(syst_names.begin(), syst_names.end(), "MetUncl_Down") != syst_names.end() && _BOOM->GetListOfBranches()->FindObject((GenName+"_UnclEnshiftedPtDown").c_str()) !=0){
+  if( down != -1 && _BOOM->GetListOfBranches()->FindObject((GenName+"_UnclEnshiftedPtDown").c_str()) !=0){
     SetBranch((GenName+"_UnclEnshiftedPtDown").c_str(), MetUnclDown[0]);
     SetBranch((GenName+"_UnclEnshiftedPhiDown").c_str(), MetUnclDown[1]);
-    Uncldown = std::find(syst_names.begin(), syst_names.end(), "MetUncl_Down")- syst_names.begin();
+    Uncldown = down;
   }
 
   activeSystematic=0;
@@ -65,10 +59,9 @@ void Met::init(){
     if(i == Unclup) systVec.at(i)->SetPtEtaPhiE(MetUnclUp[0],0,MetUnclUp[1],MetUnclUp[0]);
     else if(i == Uncldown) systVec.at(i)->SetPtEtaPhiE(MetUnclDown[0],0,MetUnclDown[1],MetUnclDown[0]);
     else if(systVec.at(i) != nullptr) addP4Syst(Reco, i);
-    
-    fill(systdeltaMEx.begin(), systdeltaMEx.end(), 0);
-    fill(systdeltaMEy.begin(), systdeltaMEy.end(), 0);
   }
+  fill(systdeltaMEx.begin(), systdeltaMEx.end(), 0);
+  fill(systdeltaMEy.begin(), systdeltaMEy.end(), 0);
   cur_P=&Reco;
 
   // syst_HT[activeSystematic]=0.;
@@ -80,27 +73,59 @@ void Met::init(){
 void Met::update(PartStats& stats, Jet& jet, int syst=0){
   ///Calculates met from values from each file plus smearing and treating muons as neutrinos
   if(systVec.at(syst) == nullptr) return;
-  double sumpxForMht=0;
-  double sumpyForMht=0;
-  double sumptForHt=0;
-
-  int i=0;
-  for(auto jetVec: jet) {
-    bool add = true;
-    if( (jetVec.Pt() < stats.dmap.at("JetPtForMhtAndHt")) ||
-        (abs(jetVec.Eta()) > stats.dmap.at("JetEtaForMhtAndHt")) ||
-        ( stats.bfind("ApplyJetLooseIDforMhtAndHt") &&
-          !jet.passedLooseJetID(i) ) ) add = false;
-    if(add) {
-      sumpxForMht -= jetVec.Px();
-      sumpyForMht -= jetVec.Py();
-      sumptForHt  += jetVec.Pt();
+  if(!htCutsLoaded) {
+    htJetPtMin = stats.dmap.at("JetPtForMhtAndHt");
+    htJetEtaMax = stats.dmap.at("JetEtaForMhtAndHt");
+    htApplyLooseID = stats.bfind("ApplyJetLooseIDforMhtAndHt");
+    htCutsLoaded = true;
+  }
+
+  const std::vector<TLorentzVector>& jets = jet.systP4(syst);
+  if(syst == 0) {
+    ////the jet ID does not change with the systematics, keep it for them
+    double sumpxForMht=0;
+    double sumpyForMht=0;
+    double sumptForHt=0;
+    jetLooseID.assign(jets.size(), true);
+    jetInHT.assign(jets.size(), false);
+    for(size_t i=0; i < jets.size(); i++) {
+      if(htApplyLooseID) jetLooseID[i] = jet.passID(i, IDBit::JetLooseID);
+      if(!passHT(jets[i], jetLooseID[i])) continue;
+      jetInHT[i] = true;
+      sumpxForMht -= jets[i].Px();
+      sumpyForMht -= jets[i].Py();
+      sumptForHt  += jets[i].Pt();
+    }
+    nominalSumPx = sumpxForMht;
+    nominalSumPy = sumpyForMht;
+    nominalSumPt = sumptForHt;
+    setHT(0, nominalSumPx, nominalSumPy, nominalSumPt);
+  } else if(!jet.needSyst(syst) || &jets == &jet.systP4(0) || jets.size() != jetInHT.size()) {
+    ////jets not moved by this systematic
+    syst_HT.at(syst) = syst_HT.at(0);
+    syst_MHT.at(syst) = syst_MHT.at(0);
+    syst_MHTphi.at(syst) = syst_MHTphi.at(0);
+  } else {
+    ////only the jets this systematic moved change the nominal sums
+    const std::vector<TLorentzVector>& nominal = jet.systP4(0);
+    double sumpxForMht=nominalSumPx;
+    double sumpyForMht=nominalSumPy;
+    double sumptForHt=nominalSumPt;
+    for(size_t i=0; i < jets.size(); i++) {
+      if(jets[i] == nominal[i]) continue;
+      if(jetInHT[i]) {
+        sumpxForMht += nominal[i].Px();
+        sumpyForMht += nominal[i].Py();
+        sumptForHt  -= nominal[i].Pt();
+      }
+      if(passHT(jets[i], jetLooseID[i])) {
+        sumpxForMht -= jets[i].Px();
+        sumpyForMht -= jets[i].Py();
+        sumptForHt  += jets[i].Pt();
+      }
     }
-    i++;
+    setHT(syst, sumpxForMht, sumpyForMht, sumptForHt);
   }
-  syst_HT.at(syst)=sumptForHt;
-  syst_MHT.at(syst)= sqrt( pow(sumpxForMht,2.0) + pow(sumpyForMht,2.0) );
-  syst_MHTphi.at(syst)=atan2(sumpyForMht,sumpxForMht);
 
   systVec.at(syst)->SetPxPyPzE(systVec.at(syst)->Px()+systdeltaMEx[syst], 
                                systVec.at(syst)->Py()+systdeltaMEy[syst], 
@@ -109,6 +134,12 @@ void Met::update(PartStats& stats, Jet& jet, int syst=0){
 
 }
 
+void Met::setHT(int syst, double sumpx, double sumpy, double sumpt) {
+  syst_HT.at(syst)=sumpt;
+  syst_MHT.at(syst)= sqrt( pow(sumpx,2.0) + pow(sumpy,2.0) );
+  syst_MHTphi.at(syst)=atan2(sumpy,sumpx);
+}
+
 double Met::pt()const         {return cur_P->Pt();}
 double Met::px()const         {return cur_P->Px();}
 double Met::py()const         {return cur_P->Py();}
@@ -125,15 +156,21 @@ double Met::MHT() const {return syst_MHT.at(activeSystematic);};
 double Met::MHTphi() const {return syst_MHTphi.at(activeSystematic);};
 
 double Met::MT2(TLorentzVector& pa, TLorentzVector& pb){
-  mt2_event.set_momenta( pa, pb, px(), py());
-  mt2_event.set_mn( MT2mass );
-  return mt2_event.get_mt2();
+  return ::MT2::calculate(pa, pb, px(), py(), MT2mass, MT2precision);
+}
+
+void Met::MT2(const std::vector< ::MT2::Input>& inputs, std::vector<double>& results) const {
+  ::MT2::calculate(inputs, results, MT2mass, MT2precision);
 }
 
 void Met::setMT2Mass(double mass){
   MT2mass=mass;
 }
 
+void Met::setMT2Precision(double precision){
+  MT2precision=precision;
+}
+
 void Met::setCurrentP(int syst){
   if( systVec.at(syst) == nullptr) {
     cur_P = systVec.at(0);
@@ -15,7 +15,7 @@
 #include <TBranch.h>
 #include <TLorentzVector.h>
 #include "Particle.h"
-#include "mt2/mt2_bisect.hh"
+#include "MT2.h"
 
 
 #include "tokenizer.hpp"
@@ -30,7 +30,7 @@ class Met {
 public:
   Met(){};
   Met(TTree*, std::string, std::string, std::vector<std::string>){};
-  Met(TTree*, std::string, std::vector<std::string>, double);
+  Met(TTree*, std::string, const SystRegistry&, double);
   virtual ~Met() {}
 
   virtual std::vector<CUTS> findExtraCuts(){return std::vector<CUTS>();}
@@ -46,12 +46,14 @@ public:
   double MHT() const;
   double MHTphi() const;
   double MT2(TLorentzVector&, TLorentzVector&);
+  void MT2(const std::vector< ::MT2::Input>&, std::vector<double>&) const;
   TLorentzVector p4() const;
   TLorentzVector& p4();
 
   void addPtEtaPhiESyst(double, double, double, double, int);
   void addP4Syst(TLorentzVector, int);
   void setMT2Mass(double);
+  void setMT2Precision(double);
   void setCurrentP(int);
   std::string getName() {return GenName;};
   void update(PartStats&, Jet&, int);
@@ -74,6 +76,7 @@ protected:
   std::string GenName;
   std::vector<std::string> syst_names;
   double MT2mass;
+  double MT2precision = mt2_bisect::RELATIVE_PRECISION;
   
   double mMet[3] = {0, 0, 0};
   //note this is only for pt and phi
@@ -81,7 +84,17 @@ protected:
   double MetUnclDown[2] = {0, 0};
   int Unclup=-1;
   int Uncldown=-1;
-  mt2_bisect::mt2 mt2_event;
+
+  ////jets in HT/MHT: cuts read once, the nominal sums and which jets entered them
+  bool htCutsLoaded = false;
+  bool htApplyLooseID = false;
+  double htJetPtMin = 0, htJetEtaMax = 0;
+  double nominalSumPx = 0, nominalSumPy = 0, nominalSumPt = 0;
+  std::vector<char> jetLooseID, jetInHT;
+  bool passHT(const TLorentzVector& jetVec, bool looseID) const {
+    return jetVec.Pt() >= htJetPtMin && std::abs(jetVec.Eta()) <= htJetEtaMax && (!htApplyLooseID || looseID);
+  }
+  void setHT(int syst, double sumpx, double sumpy, double sumpt);
   
 
 };
@@ -0,0 +1,64 @@
+#include "MT2.h"
+
+////mT^2 of a visible system (m, px, py) with an invisible one (mn, qx, qy)
+static inline double transverseMass2(double m, double px, double py, double mn, double qx, double qy) {
+  double e = sqrt(m*m + px*px + py*py);
+  double eq = sqrt(mn*mn + qx*qx + qy*qy);
+  return m*m + mn*mn + 2.*(e*eq - px*qx - py*qy);
+}
+
+MT2::Input MT2::makeInput(const TLorentzVector& pa, const TLorentzVector& pb, double metx, double mety) {
+  return {fabs(pa.M()), pa.Px(), pa.Py(), fabs(pb.M()), pb.Px(), pb.Py(), metx, mety};
+}
+
+double MT2::unbalanced(const Input& in, double mn) {
+  mn = fabs(mn);
+
+  ////side a at its minimum, the rest of the missing momentum on side b
+  if(in.ma > 0) {
+    double f = mn/in.ma, lower = in.ma + mn;
+    if(transverseMass2(in.mb, in.pbx, in.pby, mn, in.metx - f*in.pax, in.mety - f*in.pay) <= lower*lower) return lower;
+  }
+  if(in.mb > 0) {
+    double f = mn/in.mb, lower = in.mb + mn;
+    if(transverseMass2(in.ma, in.pax, in.pay, mn, in.metx - f*in.pbx, in.mety - f*in.pby) <= lower*lower) return lower;
+  }
+
+  ////all massless: 0 if the missing momentum is a positive sum of pa and pb
+  if(in.ma == 0 && in.mb == 0 && mn == 0) {
+    double det = in.pax*in.pby - in.pay*in.pbx;
+    if(det != 0) {
+      double la = (in.metx*in.pby - in.mety*in.pbx)/det;
+      double lb = (in.pax*in.mety - in.pay*in.metx)/det;
+      if(la >= 0 && lb >= 0) return 0.;
+    }
+  }
+  return -1.;
+}
+
+double MT2::calculate(const Input& in, double mn, double precision) {
+  mt2_bisect::mt2 solver;
+  solver.set_precision(precision);
+  solver.set_mn(mn);
+  solver.set_momenta(in.ma, in.pax, in.pay, in.mb, in.pbx, in.pby, in.metx, in.mety);
+  return solver.get_mt2();
+}
+
+double MT2::calculate(const TLorentzVector& pa, const TLorentzVector& pb, double metx, double mety,
+                      double mn, double precision) {
+  Input in = makeInput(pa, pb, metx, mety);
+  double mt2 = unbalanced(in, mn);
+  return (mt2 >= 0) ? mt2 : calculate(in, mn, precision);
+}
+
+void MT2::calculate(const std::vector<Input>& inputs, std::vector<double>& results, double mn, double precision) {
+  size_t n = inputs.size();
+  results.resize(n);
+
+  ////closed forms first, straight loop over all combinations
+  for(size_t i = 0; i < n; i++) results[i] = unbalanced(inputs[i], mn);
+
+  for(size_t i = 0; i < n; i++) {
+    if(results[i] < 0) results[i] = calculate(inputs[i], mn, precision);
+  }
+}
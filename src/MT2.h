@@ -0,0 +1,45 @@
+#ifndef MT2_h
+#define MT2_h
+
+#include <TLorentzVector.h>
+#include <vector>
+#include <cmath>
+#include "mt2/mt2_bisect.hh"
+
+/*
+MT2: stransverse mass of two visible systems and the missing momentum, without state.
+
+Every call makes its own mt2_bisect solver, so nothing is shared between calls and they can
+be made from several threads.  precision is relative to the largest energy of the event, the
+same as RELATIVE_PRECISION of mt2_bisect.
+
+calculate(pa, pb, metx, mety, mn, precision)
+  MT2 of one combination with invisible mass mn.
+
+calculate(inputs, results, mn, precision)
+  MT2 of many combinations (all pairs of an event).  The combinations with a closed form
+  (see unbalanced) are done in one pass over all of them, only the rest is bisected.
+
+unbalanced(input, mn)
+  MT2 if it does not need the bisection, -1 otherwise:
+    - one side can sit at its minimum ma+mn (q = pa*mn/ma) with the other side below it,
+    - massless visible and invisible particles with the missing momentum between pa and pb (0).
+*/
+namespace MT2 {
+  struct Input {
+    double ma, pax, pay;
+    double mb, pbx, pby;
+    double metx, mety;
+  };
+
+  Input makeInput(const TLorentzVector& pa, const TLorentzVector& pb, double metx, double mety);
+  double unbalanced(const Input& in, double mn);
+
+  double calculate(const Input& in, double mn, double precision=mt2_bisect::RELATIVE_PRECISION);
+  double calculate(const TLorentzVector& pa, const TLorentzVector& pb, double metx, double mety,
+                   double mn, double precision=mt2_bisect::RELATIVE_PRECISION);
+  void calculate(const std::vector<Input>& inputs, std::vector<double>& results, double mn,
+                 double precision=mt2_bisect::RELATIVE_PRECISION);
+}
+
+#endif
@@ -1,7 +1,9 @@
 #include "Particle.h"
 #include <signal.h>
 
-#define SetBranch(name, variable) BOOM->SetBranchStatus(name, 1);  BOOM->SetBranchAddress(name, &variable);
+#define SetBranch(name, variable) BranchRegistry::get(BOOM).bind(name, variable);
+////branches only read when a cut or fill uses them
+#define SetLazyBranch(name, variable) variable.bind(BOOM, name);
 
 ///////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -11,28 +13,22 @@
 
 
 //particle is a objet that stores multiple versions of the particle candidates
-Particle::Particle(TTree* _BOOM, std::string _GenName, std::string filename, std::vector<std::string> _syst_names) : BOOM(_BOOM), GenName(_GenName), syst_names(_syst_names) {
+Particle::Particle(TTree* _BOOM, std::string _GenName, std::string filename, const SystRegistry& systs) : BOOM(_BOOM), GenName(_GenName) {
   type = PType::None;
   getPartStats(filename);
 
   std::regex genName_regex(".*([A-Z][^[:space:]]+)");
-  std::regex syst_regex("([A-Za-z]+).+");
-  std::smatch mGen, mSyst;
+  std::smatch mGen;
   
   std::regex_match(GenName, mGen, genName_regex);
 
-  for( auto item : syst_names) {
-    if(item == "orig") {
+  for(size_t i = 0; i < systs.size(); i++) {
+    const SystDescriptor& syst = systs.at(i);
+    if(syst.isNominal()) {
       systVec.push_back(new std::vector<TLorentzVector>());
-      continue;
-    }
-    if(!regex_match(item, mSyst, syst_regex)){
-      systVec.push_back(nullptr);
-      continue;
-    }
-    if(mGen[1] == mSyst[1]) {
+    } else if(!syst.isWeight() && syst.object == mGen[1]) {
       systVec.push_back(new std::vector<TLorentzVector>());
-      std::cout << GenName << ": " << item << std::endl;
+      std::cout << GenName << ": " << syst.name << std::endl;
     } else {
       systVec.push_back(nullptr);
     }
@@ -91,14 +87,14 @@ void Particle::init(){
   for(auto it: systVec){
     if(it != nullptr) it->clear();
   }
-  TLorentzVector tmp;
-  for(uint i=0; i < mpt->size(); i++) {
-    tmp.SetPtEtaPhiE(mpt->at(i),meta->at(i),mphi->at(i),menergy->at(i));
-    Reco.push_back(tmp);
-
+  Span<double> pt = recoPt(), eta = recoEta(), phi = recoPhi(), energy = recoEnergy();
+  Reco.resize(pt.size());
+  for(uint i=0; i < pt.size(); i++) {
+    Reco[i].SetPtEtaPhiE(pt[i], eta[i], phi[i], energy[i]);
   }
   setCurrentP(-1);
-
+  idBits.assign(Reco.size(), 0);
+  setIDBits();
 }
 
 
@@ -111,6 +107,12 @@ bool Particle::needSyst(int syst) const {
   return systVec.at(syst) != nullptr;
 }
 
+////candidates of a systematic without changing the current one, the nominal ones if it has none
+const std::vector<TLorentzVector>& Particle::systP4(int syst) const {
+  if(systVec.at(syst) == nullptr || systVec.at(syst)->size() == 0) return *systVec.at(0);
+  return *systVec.at(syst);
+}
+
 
 void Particle::setCurrentP(int syst){
   if(syst == -1) {
@@ -124,6 +126,11 @@ void Particle::setCurrentP(int syst){
 }
 
 
+void Particle::checkBranches(TTree* tree) {
+  inFile = tree->GetBranch((GenName+"_pt").c_str()) != nullptr;
+}
+
+
 void Particle::unBranch() {
   BOOM->SetBranchStatus((GenName+"*").c_str(), 0);
 }
@@ -175,7 +182,7 @@ void Particle::getPartStats(std::string filename) {
 ///////////////////////////////////////////////////////////////////////////////////////
 
 
-Photon::Photon(TTree* _BOOM, std::string filename, std::vector<std::string> syst_names) : Particle(_BOOM, "Photon", filename, syst_names) {
+Photon::Photon(TTree* _BOOM, std::string filename, const SystRegistry& systs) : Particle(_BOOM, "Photon", filename, systs) {
   SetBranch("Photon_et", et);
   SetBranch("Photon_HoverE", hoverE);
   SetBranch("Photon_phoR9", phoR);
@@ -195,12 +202,12 @@ Photon::Photon(TTree* _BOOM, std::string filename, std::vector<std::string> syst
 ///////////////////////////////////////////////////////////////////////////////////////
 
 
-Generated::Generated(TTree* _BOOM, std::string filename, std::vector<std::string> syst_names) : Particle(_BOOM, "Gen", filename, syst_names) {
+Generated::Generated(TTree* _BOOM, std::string filename, const SystRegistry& systs) : Particle(_BOOM, "Gen", filename, systs) {
 
   SetBranch("Gen_pdg_id", pdg_id);
-  SetBranch("Gen_motherpdg_id", motherpdg_id);
-  SetBranch("Gen_status", status);
-  SetBranch("Gen_BmotherIndex", BmotherIndex);
+  SetLazyBranch("Gen_motherpdg_id", motherpdg_id);
+  SetLazyBranch("Gen_status", status);
+  SetLazyBranch("Gen_BmotherIndex", BmotherIndex);
 }
 
 
@@ -211,7 +218,7 @@ Generated::Generated(TTree* _BOOM, std::string filename, std::vector<std::string
 ///////////////////////////////////////////////////////////////////////////////////////
 
 
-Jet::Jet(TTree* _BOOM, std::string filename, std::vector<std::string> syst_names) : Particle(_BOOM, "Jet", filename, syst_names) {
+Jet::Jet(TTree* _BOOM, std::string filename, const SystRegistry& systs) : Particle(_BOOM, "Jet", filename, systs) {
   type = PType::Jet;
   SetBranch("Jet_neutralHadEnergyFraction", neutralHadEnergyFraction);
   SetBranch("Jet_neutralEmEmEnergyFraction", neutralEmEmEnergyFraction);
@@ -220,8 +227,8 @@ Jet::Jet(TTree* _BOOM, std::string filename, std::vector<std::string> syst_names
   SetBranch("Jet_chargedHadronEnergyFraction", chargedHadronEnergyFraction);
   SetBranch("Jet_chargedMultiplicity", chargedMultiplicity);
   SetBranch("Jet_chargedEmEnergyFraction", chargedEmEnergyFraction);
-  SetBranch("Jet_partonFlavour", partonFlavour);
-  SetBranch("Jet_bDiscriminator_pfCISVV2", bDiscriminator);
+  SetLazyBranch("Jet_partonFlavour", partonFlavour);
+  SetLazyBranch("Jet_bDiscriminator_pfCISVV2", bDiscriminator);
 }
 
 std::vector<CUTS> Jet::findExtraCuts() {
@@ -245,6 +252,14 @@ std::vector<CUTS> Jet::overlapCuts(CUTS ePos) {
   return returnCuts;
 }
 
+////loose ID: energy fractions and constituent counts, plus the charged ones for |eta| < 2.4.
+////Systematics only rescale the jets and keep eta, so the bit is the same for all of them
+void Jet::setIDBits() {
+  for(uint i = 0; i < idBits.size(); i++) {
+    if(passedLooseJetID(i)) idBits[i] |= 1u << static_cast<int>(IDBit::JetLooseID);
+  }
+}
+
 bool Jet::passedLooseJetID(int nobj) {
   if (neutralHadEnergyFraction->at(nobj) >= 0.99) return false;
   if (neutralEmEmEnergyFraction->at(nobj) >= 0.99) return false;
@@ -266,13 +281,13 @@ bool Jet::passedLooseJetID(int nobj) {
 ///////////////////////////////////////////////////////////////////////////////////////
 
 
-FatJet::FatJet(TTree* _BOOM, std::string filename, std::vector<std::string> syst_names) : Particle(_BOOM, "Jet_toptag", filename, syst_names) {
+FatJet::FatJet(TTree* _BOOM, std::string filename, const SystRegistry& systs) : Particle(_BOOM, "Jet_toptag", filename, systs) {
   type = PType::FatJet;
-  SetBranch("Jet_toptag_tau1", tau1);
-  SetBranch("Jet_toptag_tau2", tau2);
-  SetBranch("Jet_toptag_tau3", tau3);
-  SetBranch("Jet_toptag_PrunedMass", PrunedMass);
-  SetBranch("Jet_toptag_SoftDropMass", SoftDropMass);
+  SetLazyBranch("Jet_toptag_tau1", tau1);
+  SetLazyBranch("Jet_toptag_tau2", tau2);
+  SetLazyBranch("Jet_toptag_tau3", tau3);
+  SetLazyBranch("Jet_toptag_PrunedMass", PrunedMass);
+  SetLazyBranch("Jet_toptag_SoftDropMass", SoftDropMass);
 }
 
 std::vector<CUTS> FatJet::findExtraCuts() {
@@ -304,7 +319,7 @@ std::vector<CUTS> FatJet::overlapCuts(CUTS ePos) {
 ///////////////////////////////////////////////////////////////////////////////////////
 
 
-Lepton::Lepton(TTree* _BOOM, std::string GenName, std::string EndName, std::vector<std::string> syst_names) : Particle(_BOOM, GenName, EndName, syst_names) {
+Lepton::Lepton(TTree* _BOOM, std::string GenName, std::string EndName, const SystRegistry& systs) : Particle(_BOOM, GenName, EndName, systs) {
   SetBranch((GenName+"_charge").c_str(), _charge);
 }
 
@@ -329,15 +344,15 @@ double Lepton::charge(uint index)const     {return _charge->at(index);}
 ///////////////////////////////////////////////////////////////////////////////////////
 
 
-Electron::Electron(TTree* _BOOM, std::string filename, std::vector<std::string> syst_names) : Lepton(_BOOM, "patElectron", filename, syst_names) {
+Electron::Electron(TTree* _BOOM, std::string filename, const SystRegistry& systs) : Lepton(_BOOM, "patElectron", filename, systs) {
   type = PType::Electron;
   auto& elec1 = pstats["Elec1"];
   auto& elec2 = pstats["Elec2"];
   if(elec1.bfind("DoDiscrByIsolation") || elec2.bfind("DoDiscrByIsolation")) {
-    SetBranch("patElectron_isoChargedHadrons", isoChargedHadrons);
-    SetBranch("patElectron_isoNeutralHadrons", isoNeutralHadrons);
-    SetBranch("patElectron_isoPhotons", isoPhotons);
-    SetBranch("patElectron_isoPU", isoPU);
+    SetLazyBranch("patElectron_isoChargedHadrons", isoChargedHadrons);
+    SetLazyBranch("patElectron_isoNeutralHadrons", isoNeutralHadrons);
+    SetLazyBranch("patElectron_isoPhotons", isoPhotons);
+    SetLazyBranch("patElectron_isoPU", isoPU);
   }
   if(elec1.bfind("DoDiscrByVetoID") || elec2.bfind("DoDiscrByVetoID")) {
     SetBranch("patElectron_isPassVeto", isPassVeto);
@@ -357,6 +372,14 @@ Electron::Electron(TTree* _BOOM, std::string filename, std::vector<std::string>
 }
 
 
+void Electron::setIDBits() {
+  packIDBit(isPassVeto, IDBit::ElecVeto);
+  packIDBit(isPassLoose, IDBit::ElecLoose);
+  packIDBit(isPassMedium, IDBit::ElecMedium);
+  packIDBit(isPassTight, IDBit::ElecTight);
+  packIDBit(isPassHEEPId, IDBit::ElecHEEP);
+}
+
 bool Electron::get_Iso(int index, double min, double max) const {
   double maxIsoval = std::max(0.0, isoNeutralHadrons->at(index) + isoPhotons->at(index) - 0.5 * isoPU->at(index));
   double isoSum = (isoChargedHadrons->at(index) + maxIsoval) / pt(index);
@@ -370,7 +393,7 @@ bool Electron::get_Iso(int index, double min, double max) const {
 ///////////////////////////////////////////////////////////////////////////////////////
 
 
-Muon::Muon(TTree* _BOOM, std::string filename, std::vector<std::string> syst_names) : Lepton(_BOOM, "Muon", filename, syst_names) {
+Muon::Muon(TTree* _BOOM, std::string filename, const SystRegistry& systs) : Lepton(_BOOM, "Muon", filename, systs) {
   type = PType::Muon;
   auto& mu1 = pstats["Muon1"];
   auto& mu2 = pstats["Muon2"];
@@ -383,13 +406,18 @@ Muon::Muon(TTree* _BOOM, std::string filename, std::vector<std::string> syst_nam
   }
   if(mu1.bfind("DoDiscrByIsolation") || mu2.bfind("DoDiscrByIsolation")) {
 
-    SetBranch("Muon_isoCharged", isoCharged);
-    SetBranch("Muon_isoNeutralHadron", isoNeutralHadron);
-    SetBranch("Muon_isoPhoton", isoPhoton);
-    SetBranch("Muon_isoPU", isoPU);
+    SetLazyBranch("Muon_isoCharged", isoCharged);
+    SetLazyBranch("Muon_isoNeutralHadron", isoNeutralHadron);
+    SetLazyBranch("Muon_isoPhoton", isoPhoton);
+    SetLazyBranch("Muon_isoPU", isoPU);
   }
 }
 
+void Muon::setIDBits() {
+  packIDBit(tight, IDBit::MuonTight);
+  packIDBit(soft, IDBit::MuonSoft);
+}
+
 bool Muon::get_Iso(int index, double min, double max) const {
   double maxIsoval = std::max(0.0, isoNeutralHadron->at(index) + isoPhoton->at(index) - 0.5 * isoPU->at(index));
   double isoSum = (isoCharged->at(index) + maxIsoval) / pt(index);
@@ -403,7 +431,7 @@ bool Muon::get_Iso(int index, double min, double max) const {
 ///////////////////////////////////////////////////////////////////////////////////////
 
 
-Taus::Taus(TTree* _BOOM, std::string filename, std::vector<std::string> syst_names) : Lepton(_BOOM, "Tau", filename, syst_names) {
+Taus::Taus(TTree* _BOOM, std::string filename, const SystRegistry& systs) : Lepton(_BOOM, "Tau", filename, systs) {
   type = PType::Tau;
 
   ////Electron discrimination  
@@ -454,12 +482,12 @@ Taus::Taus(TTree* _BOOM, std::string filename, std::vector<std::string> syst_nam
 
   SetBranch("Tau_decayModeFinding", decayModeFinding);
   SetBranch("Tau_decayModeFindingNewDMs", decayModeFindingNewDMs);
-  SetBranch("Tau_nProngs", nProngs);
-  SetBranch("Tau_decayMode", decayMode);
-  SetBranch("Tau_leadChargedCandPt", leadChargedCandPt);
-  SetBranch("Tau_leadChargedCandTrack_ptError", leadChargedCandPtError);
-  SetBranch("Tau_leadChargedCandValidHits", leadChargedCandValidHits);
-  SetBranch("Tau_leadChargedCandDz_pv", leadChargedCandDz_pv);
+  SetLazyBranch("Tau_nProngs", nProngs);
+  SetLazyBranch("Tau_decayMode", decayMode);
+  SetLazyBranch("Tau_leadChargedCandPt", leadChargedCandPt);
+  SetLazyBranch("Tau_leadChargedCandTrack_ptError", leadChargedCandPtError);
+  SetLazyBranch("Tau_leadChargedCandValidHits", leadChargedCandValidHits);
+  SetLazyBranch("Tau_leadChargedCandDz_pv", leadChargedCandDz_pv);
 
 }
 
@@ -480,30 +508,33 @@ std::vector<CUTS> Taus::findExtraCuts() {
   return return_vec;
 }
 
+void Taus::setIDBits() {
+  packIDBit(againstElectron.first, IDBit::TauAgainstElec1);
+  packIDBit(againstElectron.second, IDBit::TauAgainstElec2);
+  packIDBit(againstMuon.first, IDBit::TauAgainstMuon1);
+  packIDBit(againstMuon.second, IDBit::TauAgainstMuon2);
+  packIDBit(maxIso.first, IDBit::TauMaxIso1, 0.5);
+  packIDBit(maxIso.second, IDBit::TauMaxIso2, 0.5);
+  packIDBit(decayModeFinding, IDBit::TauDMF);
+  packIDBit(decayModeFindingNewDMs, IDBit::TauNewDMs);
+
+  ////no minimum isolation branch counts as passed
+  if(minIso.first != nullptr) packIDBit(minIso.first, IDBit::TauMinIso1, 0.5);
+  else for(auto& bits: idBits) bits |= 1u << static_cast<int>(IDBit::TauMinIso1);
+  if(minIso.second != nullptr) packIDBit(minIso.second, IDBit::TauMinIso2, 0.5);
+  else for(auto& bits: idBits) bits |= 1u << static_cast<int>(IDBit::TauMinIso2);
+}
+
 bool Taus::get_Iso(int index, double onetwo, double flipisolation) const {
-  double maxIsoval = (onetwo == 1) ? maxIso.first->at(index) : maxIso.second->at(index);
-  if(!flipisolation){
-    return (maxIsoval > 0.5 );
-  } else{
-    double minIsoval=1;
-    if(onetwo == 1 ){
-      if(minIso.first!=nullptr){
-        minIsoval=minIso.first->at(index);
-      }
-    }else{
-      if(minIso.second!=nullptr){
-        minIsoval=minIso.second->at(index);
-      }
-    }
-    return (maxIsoval < 0.5 && minIsoval > 0.5);
-  }
-  return (maxIsoval > 0.5 );
+  bool maxIsoPass = passID(index, (onetwo == 1) ? IDBit::TauMaxIso1 : IDBit::TauMaxIso2);
+  if(!flipisolation) return maxIsoPass;
+  return !maxIsoPass && passID(index, (onetwo == 1) ? IDBit::TauMinIso1 : IDBit::TauMinIso2);
 }
 
-bool Taus::pass_against_Elec(CUTS ePos, int index) {
-  return (ePos == CUTS::eRTau1) ? againstElectron.first->at(index) : againstElectron.second->at(index);
+bool Taus::pass_against_Elec(CUTS ePos, int index) const {
+  return passID(index, (ePos == CUTS::eRTau1) ? IDBit::TauAgainstElec1 : IDBit::TauAgainstElec2);
 }
 
-bool Taus::pass_against_Muon(CUTS ePos, int index) {
-  return (ePos == CUTS::eRTau1) ? againstMuon.first->at(index) : againstMuon.second->at(index);
+bool Taus::pass_against_Muon(CUTS ePos, int index) const {
+  return passID(index, (ePos == CUTS::eRTau1) ? IDBit::TauAgainstMuon1 : IDBit::TauAgainstMuon2);
 }
@@ -12,6 +12,8 @@
 #include <unordered_set>
 #include <iostream>
 #include <regex>
+#include <cstdint>
+#include <algorithm>
 
 #include <TTree.h>
 #include <TBranch.h>
@@ -19,6 +21,10 @@
 
 #include "tokenizer.hpp"
 #include "Cut_enum.h"
+#include "SystRegistry.h"
+#include "BranchRegistry.h"
+#include "LazyBranch.h"
+#include "Span.h"
 
 //using namespace std;
 typedef unsigned int uint;
@@ -37,14 +43,18 @@ struct PartStats {
 };
 
 
-enum class PType { Electron, Muon, Tau, Jet, FatJet, None};
 
 
+////decisions of an object packed once per event (Particle::passID), 1/2 are the Tau1/Tau2 settings
+enum class IDBit {ElecVeto, ElecLoose, ElecMedium, ElecTight, ElecHEEP, MuonTight, MuonSoft,
+    TauAgainstElec1, TauAgainstElec2, TauAgainstMuon1, TauAgainstMuon2, TauMaxIso1, TauMaxIso2, TauMinIso1, TauMinIso2,
+    TauDMF, TauNewDMs, JetLooseID};
+
 class Particle {
 
 public:
   Particle();
-  Particle(TTree*, std::string, std::string, std::vector<std::string>);
+  Particle(TTree*, std::string, std::string, const SystRegistry&);
   virtual ~Particle() {}
 
   virtual std::vector<CUTS> findExtraCuts() {return std::vector<CUTS>();}
@@ -59,6 +69,13 @@ public:
   TLorentzVector& p4(uint);
   TLorentzVector RecoP4(uint) const;
   TLorentzVector& RecoP4(uint);
+  ////reco values as read from the branches, no copy
+  Span<double> recoPt() const {return inFile ? Span<double>(mpt) : Span<double>();}
+  Span<double> recoEta() const {return inFile ? Span<double>(meta) : Span<double>();}
+  Span<double> recoPhi() const {return inFile ? Span<double>(mphi) : Span<double>();}
+  Span<double> recoEnergy() const {return inFile ? Span<double>(menergy) : Span<double>();}
+  ////called for every file of the chain (FileHooks)
+  void checkBranches(TTree*);
 
   uint size() const;
   std::vector<TLorentzVector>::iterator begin();
@@ -67,6 +84,8 @@ public:
   std::vector<TLorentzVector>::const_iterator end() const;
 
   bool needSyst(int) const;
+  bool passID(uint index, IDBit bit) const {return idBits[index] & (1u << static_cast<int>(bit));}
+  const std::vector<TLorentzVector>& systP4(int) const;
 
   void addPtEtaPhiESyst(double, double, double, double, int);
   void addP4Syst(TLorentzVector, int);
@@ -84,6 +103,17 @@ public:
 
 protected:
   void getPartStats(std::string);
+  ////called by init() with the reco particles of the event, fills idBits from the branches
+  virtual void setIDBits() {}
+  template <typename T> void packIDBit(const std::vector<T>* decisions, IDBit bit, double above=0) {
+    if(decisions == nullptr) return;
+    uint32_t mask = 1u << static_cast<int>(bit);
+    size_t n = std::min(idBits.size(), decisions->size());
+    for(size_t i = 0; i < n; i++) {
+      if((*decisions)[i] > above) idBits[i] |= mask;
+    }
+  }
+  std::vector<uint32_t> idBits;
   TTree* BOOM;
   std::string GenName;
   std::unordered_map<CUTS, std::string, EnumHash> jetNameMap = {
@@ -98,10 +128,11 @@ protected:
   std::vector<double>* meta = 0;
   std::vector<double>* mphi = 0;
   std::vector<double>* menergy = 0;
+  ////false in a file without the branches, ROOT would leave the values of the last file
+  bool inFile = true;
 
   std::vector<TLorentzVector> Reco;
   std::vector<TLorentzVector> *cur_P;
-  std::vector<std::string> syst_names;
   std::vector<std::vector<TLorentzVector>* > systVec;
 
   std::string activeSystematic;
@@ -110,7 +141,7 @@ protected:
 class Photon : public Particle {
 public:
   Photon();
-  Photon(TTree*, std::string, std::vector<std::string>);
+  Photon(TTree*, std::string, const SystRegistry&);
 
   std::vector<double>* et = 0;
   std::vector<double>* hoverE = 0;
@@ -130,12 +161,12 @@ class Generated : public Particle {
 
 public:
   Generated();
-  Generated(TTree*, std::string, std::vector<std::string>);
+  Generated(TTree*, std::string, const SystRegistry&);
 
   std::vector<double>  *pdg_id = 0;
-  std::vector<double>  *motherpdg_id = 0;
-  std::vector<double>  *status = 0;
-  std::vector<int>  *BmotherIndex = 0;
+  LazyBranch<std::vector<double> > motherpdg_id;
+  LazyBranch<std::vector<double> > status;
+  LazyBranch<std::vector<int> > BmotherIndex;
 
 };
 
@@ -143,7 +174,7 @@ public:
 class Jet : public Particle {
 
 public:
-  Jet(TTree*, std::string, std::vector<std::string>);
+  Jet(TTree*, std::string, const SystRegistry&);
 
   std::vector<CUTS> findExtraCuts();
   std::vector<CUTS> overlapCuts(CUTS);
@@ -156,8 +187,8 @@ public:
   std::vector<double>* chargedHadronEnergyFraction = 0;
   std::vector<int>*    chargedMultiplicity = 0;
   std::vector<double>* chargedEmEnergyFraction = 0;
-  std::vector<int>*    partonFlavour = 0;
-  std::vector<double>* bDiscriminator = 0;
+  LazyBranch<std::vector<int> >    partonFlavour;
+  LazyBranch<std::vector<double> > bDiscriminator;
   std::vector<double>* tau1 = 0;
   std::vector<double>* tau2 = 0;
   std::vector<double>* tau3 = 0;
@@ -165,29 +196,29 @@ public:
   std::vector<double>* SoftDropMass = 0;
 
  protected:
-
+  void setIDBits();
 };
 
 class FatJet : public Particle {
 
 public:
-  FatJet(TTree*, std::string, std::vector<std::string>);
+  FatJet(TTree*, std::string, const SystRegistry&);
 
   std::vector<CUTS> findExtraCuts();
   std::vector<CUTS> overlapCuts(CUTS);
 
-  std::vector<double>* tau1 = 0;
-  std::vector<double>* tau2 = 0;
-  std::vector<double>* tau3 = 0;
-  std::vector<double>* PrunedMass = 0;
-  std::vector<double>* SoftDropMass = 0;
+  LazyBranch<std::vector<double> > tau1;
+  LazyBranch<std::vector<double> > tau2;
+  LazyBranch<std::vector<double> > tau3;
+  LazyBranch<std::vector<double> > PrunedMass;
+  LazyBranch<std::vector<double> > SoftDropMass;
 
 };
 
 class Lepton : public Particle {
 
 public:
-  Lepton(TTree*, std::string, std::string, std::vector<std::string>);
+  Lepton(TTree*, std::string, std::string, const SystRegistry&);
 
   std::vector<CUTS> findExtraCuts();
 
@@ -201,7 +232,7 @@ public:
 class Electron : public Lepton {
 
 public:
-  Electron(TTree*, std::string, std::vector<std::string>);
+  Electron(TTree*, std::string, const SystRegistry&);
 
   bool get_Iso(int, double, double) const;
 
@@ -210,10 +241,13 @@ public:
   std::vector<int>     *isPassMedium = 0;
   std::vector<int>     *isPassTight = 0;
   std::vector<int>     *isPassHEEPId = 0;
-  std::vector<double>  *isoChargedHadrons = 0;
-  std::vector<double>  *isoNeutralHadrons = 0;
-  std::vector<double>  *isoPhotons = 0;
-  std::vector<double>  *isoPU = 0;
+  LazyBranch<std::vector<double> > isoChargedHadrons;
+  LazyBranch<std::vector<double> > isoNeutralHadrons;
+  LazyBranch<std::vector<double> > isoPhotons;
+  LazyBranch<std::vector<double> > isoPU;
+
+ protected:
+  void setIDBits();
 };
 
 
@@ -221,41 +255,47 @@ public:
 class Muon : public Lepton {
 
 public:
-  Muon(TTree*, std::string, std::vector<std::string>);
+  Muon(TTree*, std::string, const SystRegistry&);
 
   bool get_Iso(int, double, double) const;
 
   std::vector<bool>* tight = 0;
   std::vector<bool>* soft = 0;
-  std::vector<double>* isoCharged = 0;
-  std::vector<double>* isoNeutralHadron = 0;
-  std::vector<double>* isoPhoton = 0;
-  std::vector<double>* isoPU = 0;
+  LazyBranch<std::vector<double> > isoCharged;
+  LazyBranch<std::vector<double> > isoNeutralHadron;
+  LazyBranch<std::vector<double> > isoPhoton;
+  LazyBranch<std::vector<double> > isoPU;
+
+ protected:
+  void setIDBits();
 };
 
 class Taus : public Lepton {
 
 public:
-  Taus(TTree*, std::string, std::vector<std::string>);
+  Taus(TTree*, std::string, const SystRegistry&);
 
   //  void findExtraCuts();
   std::vector<CUTS> findExtraCuts();
   bool get_Iso(int, double, double) const;
-  bool pass_against_Elec(CUTS, int);
-  bool pass_against_Muon(CUTS, int);
+  bool pass_against_Elec(CUTS, int) const;
+  bool pass_against_Muon(CUTS, int) const;
 
   std::vector<int>     *decayModeFindingNewDMs = 0;
   std::vector<int>     *decayModeFinding = 0;
-  std::vector<double>  *nProngs = 0;
-  std::vector<int>  *decayMode = 0;
+  LazyBranch<std::vector<double> > nProngs;
+  LazyBranch<std::vector<int> > decayMode;
   std::pair<std::vector<int>*,std::vector<int>* > againstElectron = std::make_pair(nullptr,nullptr);
   std::pair<std::vector<int>*,std::vector<int>* > againstMuon = std::make_pair(nullptr,nullptr);
   std::pair<std::vector<int>*,std::vector<int>* > minIso = std::make_pair(nullptr,nullptr);
   std::pair<std::vector<int>*,std::vector<int>* > maxIso = std::make_pair(nullptr,nullptr);
-  std::vector<double>  *leadChargedCandPt = 0;
-  std::vector<double>  *leadChargedCandPtError = 0;
-  std::vector<double>  *leadChargedCandValidHits = 0;
-  std::vector<double>  *leadChargedCandDz_pv = 0;
+  LazyBranch<std::vector<double> > leadChargedCandPt;
+  LazyBranch<std::vector<double> > leadChargedCandPtError;
+  LazyBranch<std::vector<double> > leadChargedCandValidHits;
+  LazyBranch<std::vector<double> > leadChargedCandDz_pv;
+
+ protected:
+  void setIDBits();
 };
 
 
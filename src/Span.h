@@ -0,0 +1,35 @@
+#ifndef Span_h
+#define Span_h
+
+#include <cstddef>
+#include <vector>
+
+/*
+Span: read only view of a contiguous array, without owning or copying it.
+
+Made from the vector ROOT fills for a branch, it points into that vector's buffer, so it
+stays valid until the next GetEntry.  data() can be given straight to the array kernels
+(kin::, JetScaleResolution::GetSourceShifts).
+*/
+template <typename T>
+class Span {
+public:
+  Span() {}
+  Span(const T* _data, size_t _size) : first(_data), n(_size) {}
+  Span(const std::vector<T>& vec) : first(vec.data()), n(vec.size()) {}
+  ////a branch that is not in the tree is an empty span
+  Span(const std::vector<T>* vec) : first(vec ? vec->data() : nullptr), n(vec ? vec->size() : 0) {}
+
+  const T* data() const {return first;}
+  size_t size() const {return n;}
+  bool empty() const {return n == 0;}
+  const T& operator[](size_t i) const {return first[i];}
+  const T* begin() const {return first;}
+  const T* end() const {return first + n;}
+
+private:
+  const T* first = nullptr;
+  size_t n = 0;
+};
+
+#endif
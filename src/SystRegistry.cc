@@ -0,0 +1,98 @@
+#include "SystRegistry.h"
+
+static_assert(static_cast<int>(CUTS::Last) < 64, "the cuts of a systematic are kept in 64 bits");
+
+#define cutbit(x) (1ULL << static_cast<int>(x))
+
+static const std::vector<std::pair<std::string, PType> > objectTypes = {
+  {"Electron", PType::Electron}, {"Muon", PType::Muon}, {"Tau", PType::Tau}, {"Jet", PType::Jet}
+};
+
+////selections made directly from the particles of each type
+static const std::vector<std::pair<PType, std::vector<CUTS> > > typeCuts = {
+  {PType::Electron, {CUTS::eRElec1, CUTS::eRElec2}},
+  {PType::Muon, {CUTS::eRMuon1, CUTS::eRMuon2}},
+  {PType::Tau, {CUTS::eRTau1, CUTS::eRTau2}},
+  {PType::Jet, {CUTS::eRJet1, CUTS::eRJet2, CUTS::eRCenJet, CUTS::eR1stJet, CUTS::eR2ndJet, CUTS::eRBJet}},
+};
+
+static bool endsWith(const std::string& name, const std::string& end) {
+  return name.size() >= end.size() && name.compare(name.size() - end.size(), end.size(), end) == 0;
+}
+
+int SystRegistry::add(std::string name, int jesSource) {
+  SystDescriptor desc;
+  desc.name = name;
+  desc.jesSource = jesSource;
+
+  ////leading letters, as long as something follows them
+  size_t wordEnd = name.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz");
+  if(wordEnd != 0 && wordEnd != std::string::npos) desc.object = name.substr(0, wordEnd);
+
+  if(endsWith(name, "_Up")) desc.direction = 1;
+  else if(endsWith(name, "_Down")) desc.direction = -1;
+
+  if(name == "orig") {
+    desc.kind = SystKind::Nominal;
+    desc.types = ~0u;
+    desc.shiftsMet = true;
+  } else if(name.find("weight") != std::string::npos) {
+    desc.kind = SystKind::Weight;
+  } else {
+    if(name.find("_Res_") != std::string::npos) desc.kind = SystKind::Resolution;
+    else if(name.find("_Scale_") != std::string::npos) desc.kind = SystKind::Scale;
+    else if(desc.object == "MetUncl") desc.kind = SystKind::Unclustered;
+    for(auto& type: objectTypes) {
+      if(desc.object == type.first) desc.types |= 1u << static_cast<int>(type.second);
+    }
+    desc.shiftsMet = (name.find("Tau_qcd") == std::string::npos);
+  }
+  if(desc.jesSource >= 0 && (desc.kind != SystKind::Scale || !desc.affects(PType::Jet))) {
+    std::cout << "ERROR: " << name << " is not a jet energy scale systematic" << std::endl;
+    exit(1);
+  }
+
+  descriptors.push_back(desc);
+  systNames.push_back(name);
+  return descriptors.size()-1;
+}
+
+void SystRegistry::propagate(const std::vector<std::pair<CUTS, CUTS> >& dependencies) {
+  for(auto& desc: descriptors) {
+    if(desc.isNominal()) {
+      desc.cuts = ~0ULL;
+      continue;
+    }
+    desc.cuts = 0;
+    for(auto& type: typeCuts) {
+      if(!desc.affects(type.first)) continue;
+      for(auto cut: type.second) desc.cuts |= cutbit(cut);
+    }
+    if(desc.shiftsMet) desc.cuts |= cutbit(CUTS::eMET);
+
+    bool changed = (desc.cuts != 0);
+    while(changed) {
+      changed = false;
+      for(auto& dep: dependencies) {
+        if((desc.cuts & cutbit(dep.second)) && !(desc.cuts & cutbit(dep.first))) {
+          desc.cuts |= cutbit(dep.first);
+          changed = true;
+        }
+      }
+    }
+  }
+}
+
+int SystRegistry::find(const std::string& name) const {
+  for(size_t i = 0; i < systNames.size(); i++) {
+    if(systNames[i] == name) return i;
+  }
+  return -1;
+}
+
+int SystRegistry::find(SystKind kind, int direction) const {
+  for(size_t i = 0; i < descriptors.size(); i++) {
+    if(descriptors[i].kind == kind && descriptors[i].direction == direction) return i;
+  }
+  return -1;
+}
@@ -0,0 +1,68 @@
+#ifndef SystRegistry_h
+#define SystRegistry_h
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include "Cut_enum.h"
+
+enum class SystKind { Nominal, Scale, Resolution, Unclustered, Weight, Other };
+
+/*
+SystDescriptor: what a systematic (one name of Systematics_info.in) does, read once from its name.
+
+  <Object>_Scale_Up, <Object>_Res_Down, ...   kind Scale/Resolution of the object's energy
+  MetUncl_Up/Down                             unclustered MET
+  names with "weight"                         only change the event weight
+  Jet_Scale_<source>_Up/Down                  one JES source (jesSource >= 0)
+
+types and cuts hold the particle types moved by the systematic and the selections (CUTS)
+that can change because of it, so the per event checks are bit tests.
+*/
+struct SystDescriptor {
+  std::string name;
+  SystKind kind = SystKind::Other;
+  ////+1 up, -1 down, 0 otherwise
+  int direction = 0;
+  ////first word of the name (Electron, Muon, Tau, Jet, Met, ...)
+  std::string object;
+  unsigned types = 0;
+  bool shiftsMet = false;
+  int jesSource = -1;
+  uint64_t cuts = 0;
+
+  bool affects(PType type) const {return types & (1u << static_cast<int>(type));}
+  bool affects(CUTS cut) const {return cuts & (1ULL << static_cast<int>(cut));}
+  bool isNominal() const {return kind == SystKind::Nominal;}
+  bool isWeight() const {return kind == SystKind::Weight;}
+};
+
+/*
+SystRegistry: the systematics of the job in the order of the folders, "orig" first.
+
+add(name, jesSource)
+  Parses the name into its descriptor and returns its index.
+
+propagate(dependencies)
+  Fills the cuts of every descriptor: the selections of the particles it moves (and MET if it
+  is shifted), then every selection that depends on one of those, with (cut, depends on) pairs.
+*/
+class SystRegistry {
+ public:
+  int add(std::string name, int jesSource=-1);
+  void propagate(const std::vector<std::pair<CUTS, CUTS> >& dependencies);
+
+  const SystDescriptor& at(size_t i) const {return descriptors.at(i);}
+  size_t size() const {return descriptors.size();}
+  int find(const std::string& name) const;
+  int find(SystKind kind, int direction) const;
+  const std::vector<std::string>& names() const {return systNames;}
+
+ private:
+  std::vector<SystDescriptor> descriptors;
+  std::vector<std::string> systNames;
+};
+
+#endif
@@ -41,19 +41,18 @@ void Systematics::shiftLepton(Lepton& lepton, TLorentzVector recoLep, TLorentzVe
 }
 
 
-void Systematics::loadScaleRes(const PartStats& smear, const PartStats& syst, std::string syst_name) {
+void Systematics::loadScaleRes(const PartStats& smear, const PartStats& syst, const SystDescriptor& desc) {
   scale = 1;
   resolution = 1;
   if(smear.bfind("SmearTheParticle")) {
     scale = smear.dmap.at("PtScaleOffset");
     resolution = smear.dmap.at("PtResolutionOffset");
   } 
-  if(syst_name.find("_Res_")) {
-    resolution = syst_name.find("_Up") ? 1 + syst.dmap.at("res") : 1 - syst.dmap.at("res");
+  if(desc.kind == SystKind::Resolution) {
+    resolution = (desc.direction > 0) ? 1 + syst.dmap.at("res") : 1 - syst.dmap.at("res");
     scale=1;
-  } else if(syst_name.find("_Scale_")) {
-    scale = syst_name.find("_Up") ? 1+syst.dmap.at("scale") : 1- syst.dmap.at("scale");
+  } else if(desc.kind == SystKind::Scale) {
+    scale = (desc.direction > 0) ? 1+syst.dmap.at("scale") : 1- syst.dmap.at("scale");
     resolution=1;
   }
 }
-
@@ -6,6 +6,7 @@
 #include <functional>
 #include <unordered_map>
 #include "Particle.h"
+#include "SystRegistry.h"
 //#include <boost/unordered_map.hpp>
 
 // we will put stuff from the main analyser here once we know what
@@ -24,7 +25,7 @@ public:
 
   void shiftParticle(Particle& jet, TLorentzVector recJet, double const& ratio, double& dPx, double& dPy, int syst);
   void shiftLepton(Lepton& lepton, TLorentzVector recoLep, TLorentzVector genLep, double& dPx, double& dPy, int syst);
-  void loadScaleRes(const PartStats& smear, const PartStats& syst, std::string syst_name);
+  void loadScaleRes(const PartStats& smear, const PartStats& syst, const SystDescriptor& desc);
 
 private:
   double scale;
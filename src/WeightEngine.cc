@@ -0,0 +1,115 @@
+#include "WeightEngine.h"
+
+LookupTable::LookupTable(std::vector<double> _edges, std::vector<double> _values, bool _upperInclusive) :
+  edges(_edges), values(_values), upperInclusive(_upperInclusive) {
+  if(values.size() != edges.size()+1) {
+    std::cout << "ERROR: lookup table needs one value more than bin edges (under- and overflow)" << std::endl;
+    exit(1);
+  }
+}
+
+LookupTable::LookupTable(const TH1* hist) {
+  if(hist == nullptr) {
+    std::cout << "ERROR: no histogram for the lookup table" << std::endl;
+    exit(1);
+  }
+  int nbins = hist->GetNbinsX();
+  for(int i = 1; i <= nbins+1; i++) edges.push_back(hist->GetXaxis()->GetBinLowEdge(i));
+  for(int i = 0; i <= nbins+1; i++) values.push_back(hist->GetBinContent(i));
+}
+
+
+std::unique_ptr<TH1D> WeightEngine::detachedHist(const std::string& name) {
+  std::unique_ptr<TH1D> hist(new TH1D(name.c_str(), name.c_str(), 200, -5, 5));
+  hist->SetDirectory(nullptr);
+  return hist;
+}
+
+void WeightEngine::setMonitor(bool _monitor) {
+  monitor = _monitor;
+  total = detachedHist("Weight");
+}
+
+void WeightEngine::addProvider(std::string name, Provider provider, std::string upSyst, std::string downSyst) {
+  names.push_back(name);
+  providers.push_back(provider);
+  upSysts.push_back(upSyst);
+  downSysts.push_back(downSyst);
+
+  nom.assign(names.size(), 1.);
+  up.assign(names.size(), 1.);
+  down.assign(names.size(), 1.);
+  prefix.assign(names.size()+1, 1.);
+  variants.assign(2*names.size(), 1.);
+  seconds.assign(names.size(), 0.);
+  distributions.push_back(detachedHist(name));
+  std::cout << "Event weight: " << name << std::endl;
+}
+
+void WeightEngine::evaluate() {
+  size_t nprov = providers.size();
+  if(monitor) {
+    for(size_t i = 0; i < nprov; i++) {
+      auto start = std::chrono::steady_clock::now();
+      providers[i](nom[i], up[i], down[i]);
+      seconds[i] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+  } else {
+    for(size_t i = 0; i < nprov; i++) providers[i](nom[i], up[i], down[i]);
+  }
+
+  ////variation i = (product of nominals before i) * up/down of i * (product of nominals after i)
+  for(size_t i = 0; i < nprov; i++) prefix[i+1] = prefix[i]*nom[i];
+  double suffix = 1.;
+  for(int i = (int)nprov-1; i >= 0; i--) {
+    double others = prefix[i]*suffix;
+    variants[2*i] = others*up[i];
+    variants[2*i+1] = others*down[i];
+    suffix *= nom[i];
+  }
+  nominalWeight = prefix[nprov];
+
+  if(monitor) {
+    nevents++;
+    for(size_t i = 0; i < nprov; i++) distributions[i]->Fill(nom[i]);
+    total->Fill(nominalWeight);
+  }
+}
+
+int WeightEngine::variantIndex(const std::string& syst) const {
+  for(size_t i = 0; i < names.size(); i++) {
+    if(upSysts[i] == syst) return 2*i;
+    if(downSysts[i] == syst) return 2*i+1;
+  }
+  return -1;
+}
+
+void WeightEngine::print() const {
+  if(!monitor || names.size() == 0) return;
+  std::cout << "                        Weight          us/event        mean         rms" << std::endl;
+  std::cout << "---------------------------------------------------------------------------\n";
+  for(size_t i = 0; i < names.size(); i++) {
+    std::cout << std::setw(30) << names[i] << std::setw(16) << ((nevents > 0) ? 1e6*seconds[i]/nevents : 0.)
+              << std::setw(12) << distributions[i]->GetMean() << std::setw(12) << distributions[i]->GetRMS() << std::endl;
+  }
+  std::cout << std::setw(30) << "Total" << std::setw(16) << "" << std::setw(12) << total->GetMean() << std::setw(12) << total->GetRMS() << std::endl;
+  std::cout << "---------------------------------------------------------------------------\n";
+}
+
+void WeightEngine::write(std::string outname) {
+  if(!monitor || names.size() == 0) return;
+  TH1D timing("Timing", "Timing (us/event)", names.size(), 0, names.size());
+  for(size_t i = 0; i < names.size(); i++) {
+    timing.GetXaxis()->SetBinLabel(i+1, names[i].c_str());
+    timing.SetBinContent(i+1, (nevents > 0) ? 1e6*seconds[i]/nevents : 0.);
+  }
+
+  TFile* outfile = new TFile(outname.c_str(), "UPDATE");
+  if(outfile->GetDirectory("Weights") == nullptr) outfile->mkdir("Weights");
+  outfile->cd("Weights");
+  for(auto& dist: distributions) dist->Write();
+  total->Write();
+  timing.Write();
+  outfile->Close();
+  delete outfile;
+}
@@ -0,0 +1,87 @@
+#ifndef WeightEngine_h
+#define WeightEngine_h
+
+#include <TH1.h>
+#include <TFile.h>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <memory>
+
+/*
+LookupTable: flat copy of a 1D histogram (or of a table of bin edges) for per event lookups.
+
+Bin i covers [edges[i-1], edges[i]), bin 0 is the underflow and bin edges.size() the
+overflow, same as TH1::FindBin.  With upperInclusive the bins are (edges[i-1], edges[i]].
+*/
+struct LookupTable {
+  std::vector<double> edges, values;
+  bool upperInclusive = false;
+
+  LookupTable() {}
+  LookupTable(std::vector<double> _edges, std::vector<double> _values, bool _upperInclusive=false);
+  LookupTable(const TH1*);
+  double at(double x) const {
+    size_t bin = (upperInclusive) ? std::lower_bound(edges.begin(), edges.end(), x) - edges.begin()
+                                  : std::upper_bound(edges.begin(), edges.end(), x) - edges.begin();
+    return values[bin];
+  }
+  bool empty() const {return values.empty();}
+};
+
+/*
+WeightEngine: event weight built from an ordered list of providers.
+
+Each provider gives its nominal, up and down factor of the event.  The providers are chosen
+once when the analyzer is set up, evaluate() then calls each of them once per event and
+builds the nominal weight and every variation (one provider moved up or down, the others
+nominal) from prefix and suffix products, so no factor is divided out again.
+
+addProvider(name, function, upSyst, downSyst)
+  upSyst/downSyst are the systematics (Systematics_info.in) given by this provider's variations.
+
+variantIndex(syst)
+  Position of a systematic in variants(), -1 if no provider varies it (it is then the nominal).
+
+setMonitor(true)
+  Keeps the time spent in every provider and the distribution of its nominal factor, shown by
+  print() and written to Weights/ by write().  These histograms are detached from the current
+  directory, the engine owns them.
+*/
+class WeightEngine {
+ public:
+  typedef std::function<void(double&, double&, double&)> Provider;
+
+  void addProvider(std::string name, Provider provider, std::string upSyst="", std::string downSyst="");
+  void evaluate();
+  double nominal() const {return nominalWeight;}
+  double variant(int index) const {return (index < 0) ? nominalWeight : variants[index];}
+  int variantIndex(const std::string& syst) const;
+  size_t size() const {return names.size();}
+
+  void setMonitor(bool);
+  void print() const;
+  void write(std::string outname);
+
+ private:
+  std::vector<std::string> names, upSysts, downSysts;
+  std::vector<Provider> providers;
+  std::vector<double> nom, up, down, variants;
+  std::vector<double> prefix = {1.};
+  double nominalWeight = 1.;
+
+  bool monitor = false;
+  long nevents = 0;
+  std::vector<double> seconds;
+  std::vector<std::unique_ptr<TH1D> > distributions;
+  std::unique_ptr<TH1D> total;
+
+  static std::unique_ptr<TH1D> detachedHist(const std::string& name);
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "Analyzer.h"
 #include <csignal>
+#include <sstream>
 #define Q(x) #x
 #define QUOTE(x) Q(x)
 #include QUOTE(MYANA)
@@ -20,6 +21,8 @@ void usage() {
   std::cout << "Available options are:\n";
   std::cout << "-CR: to run over the control regions (not the usual output)\n";
   std::cout << "-C: use a different config folder than the default 'PartDet'\n";
+  std::cout << "    several folders separated by commas (-C cfgA,cfgB) are run over one read of the input,\n";
+  std::cout << "    each writing to outfile_<folder>.root\n";
   std::cout << "-t: run over 100 events\n";
   std::cout << "\n";
 
@@ -93,6 +96,25 @@ void parseCommandLine(int argc, char *argv[], std::vector<std::string> &inputnam
   return;
 }
 
+std::vector<std::string> splitConfigFolders(const std::string& configFolder) {
+  std::vector<std::string> folders;
+  std::stringstream ss(configFolder);
+  std::string folder;
+  while(getline(ss, folder, ',')) {
+    if(folder != "") folders.push_back(folder);
+  }
+  return folders;
+}
+
+////outfile.root -> outfile_cfgA.root, so every configuration keeps its own output
+std::string configOutputName(const std::string& outputname, std::string configFolder) {
+  while(configFolder.size() > 1 && configFolder.back() == '/') configFolder.pop_back();
+  std::string tag = configFolder.substr(configFolder.find_last_of('/')+1);
+  size_t dot = outputname.rfind(".root");
+  if(dot == std::string::npos) return outputname+"_"+tag;
+  return outputname.substr(0, dot)+"_"+tag+outputname.substr(dot);
+}
+
 int main (int argc, char* argv[]) {
 
   bool setCR = false;
@@ -108,8 +130,20 @@ int main (int argc, char* argv[]) {
   parseCommandLine(argc, argv, inputnames, outputname, setCR, testRun, configFolder);
 
 
-  //setup the analyser
-  Analyzer testing(inputnames, outputname, setCR, configFolder);
+  //setup the analysers, all configurations share the input of the first one
+  std::vector<std::string> configFolders = splitConfigFolders(configFolder);
+  if(configFolders.size() == 0) usage();
+  std::vector<Analyzer*> analyzers;
+  for(auto folder: configFolders) {
+    std::string outname = (configFolders.size() == 1) ? outputname : configOutputName(outputname, folder);
+    Analyzer* shared = analyzers.empty() ? nullptr : analyzers.front();
+    analyzers.push_back(new Analyzer(inputnames, outname, setCR, folder, shared));
+    ////the scanned cuts are loosened in a second copy of the configuration, with its own output
+    if(analyzers.back()->runsCutScan()) {
+      analyzers.push_back(new Analyzer(inputnames, configOutputName(outname, "CutScan"), setCR, folder, analyzers.front(), true));
+    }
+  }
+  Analyzer& testing = *analyzers.front();
   SpechialAnalysis spechialAna = SpechialAnalysis(&testing);
   spechialAna.init();
 
@@ -120,25 +154,35 @@ int main (int argc, char* argv[]) {
   size_t Nentries=testing.nentries;
   if(testRun){
     Nentries=100;
-    testing.nentries=100;
+    for(auto ana: analyzers) ana->nentries=100;
   }
   //main event loop
   for(size_t i=0; i < Nentries; i++) {
     if(i==0){
       spechialAna.begin_run();
     }
-    testing.clear_values();
-    testing.preprocess(i);
-    testing.fill_efficiency();
-    testing.fill_histogram();
+    for(auto ana: analyzers) {
+      ana->clear_values();
+      if(!ana->preprocess(i)) {
+        ana->fill_Rejected();
+        continue;
+      }
+      ana->fill_efficiency();
+      ana->fill_histogram();
+    }
     spechialAna.analyze();
     //this will be set if ctrl+c is pressed
     if(do_break){
-      testing.nentries=i+1;
+      Nentries=i+1;
       break;
     }
   }
-  testing.printCuts();
+  for(auto ana: analyzers) {
+    if(do_break) ana->nentries=Nentries;
+    ana->printCuts();
+  }
   spechialAna.end_run();
+  ////the first analyser owns the input, delete it last
+  for(auto it = analyzers.rbegin(); it != analyzers.rend(); it++) delete *it;
   return 0;
 }
@@ -49,6 +49,15 @@ mt2::mt2()
    momenta_set = false;
    mt2_b  = 0.;
    scale = 1.;
+   relative_precision = RELATIVE_PRECISION;
+}
+
+void mt2::set_precision(double relative)
+{
+   solved = false;
+   relative_precision = relative;
+   if (ABSOLUTE_PRECISION > 100.*relative_precision) precision = ABSOLUTE_PRECISION;
+   else precision = 100.*relative_precision;
 }
 
 double mt2::get_mt2()
@@ -62,8 +71,13 @@ double mt2::get_mt2()
 //void mt2::set_momenta(double* pa0, double* pb0, double* pmiss0)
 void mt2::set_momenta(TLorentzVector& pa, TLorentzVector& pb, double pmiss0x, double pmiss0y)
 {
-   double pa0[3]={pa.M(), pa.Px(), pa.Py()};
-   double pb0[3]={pb.M(), pb.Px(), pb.Py()};
+   set_momenta(pa.M(), pa.Px(), pa.Py(), pb.M(), pb.Px(), pb.Py(), pmiss0x, pmiss0y);
+}
+
+void mt2::set_momenta(double ma0, double pax0, double pay0, double mb0, double pbx0, double pby0, double pmiss0x, double pmiss0y)
+{
+   double pa0[3]={ma0, pax0, pay0};
+   double pb0[3]={mb0, pbx0, pby0};
    double pmiss0[3]={0,pmiss0x,pmiss0y};
    
    solved = false;     //reset solved tag when momenta are changed.
@@ -128,8 +142,8 @@ void mt2::set_momenta(TLorentzVector& pa, TLorentzVector& pb, double pmiss0x, do
    mn   = mn_unscale/scale; 
    mnsq = mn*mn;
   
-   if (ABSOLUTE_PRECISION > 100.*RELATIVE_PRECISION) precision = ABSOLUTE_PRECISION;
-   else precision = 100.*RELATIVE_PRECISION;
+   if (ABSOLUTE_PRECISION > 100.*relative_precision) precision = ABSOLUTE_PRECISION;
+   else precision = 100.*relative_precision;
 }
 
 void mt2::set_mn(double mn0)
@@ -44,7 +44,10 @@ class mt2
       void   mt2_bisect();
       void   mt2_massless();
       void   set_momenta(TLorentzVector& pa, TLorentzVector& pb, double pmiss0x, double pmiss0y);
+      void   set_momenta(double ma0, double pax0, double pay0, double mb0, double pbx0, double pby0, double pmiss0x, double pmiss0y);
       void   set_mn(double mn);
+      //relative precision, RELATIVE_PRECISION if not set
+      void   set_precision(double relative);
       double get_mt2();
   // void   print();
       int    nevt;
@@ -78,6 +81,7 @@ class mt2
 
       double scale;
       double precision;
+      double relative_precision;
 };
 
 }//end namespace mt2_bisect